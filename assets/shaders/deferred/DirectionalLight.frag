@@ -0,0 +1,186 @@
+#version 430 core
+// Ambient, directional and spot lights of every pixel the G-buffer covers, and its depth,
+// so whatever is drawn forward afterwards is tested against the scene.
+
+struct DirLight {
+    vec3 direction;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};  
+
+struct SpotLight {
+    vec3  position;
+    vec3  direction;
+    float cutOff;
+    float outerCutOff;
+
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};  
+
+// CalcDirShadow is the lit shaders', the loader has no includes: keep it identical to
+// lit/FragmentShader.frag
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);  
+float CalcDirShadow(vec3 normal, vec3 lightDir);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);  
+vec3 DecodeNormal(vec2 encoded);
+vec3 SkyIrradiance(vec3 n);
+
+uniform DirLight dirLight;
+
+// Diffuse light from the sky, its L2 spherical harmonics convolved with the cosine lobe,
+// see projectCubemap. Replaces the directional light's flat ambient with skyAmbient set.
+uniform vec3 shCoefficients[9];
+uniform bool skyAmbient;
+uniform float skyAmbientIntensity;
+
+#define NR_SPOT_LIGHTS 1
+uniform SpotLight spotLights[NR_SPOT_LIGHTS];
+
+// G-buffer, see DeferredRenderer
+uniform sampler2D gAlbedoSpecular; // rgb albedo, a specular intensity
+uniform sampler2D gNormal; // octahedral normal in rg, log2 of the shininess over 11 in b
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+uniform vec3 viewPos;
+
+// Cascaded shadow map of the directional light, see CascadedShadowMap
+#define MAX_CASCADES 4
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 cascadeMatrices[MAX_CASCADES];
+uniform float cascadeSplits[MAX_CASCADES]; // far end of every cascade, view-space distance
+uniform float cascadeTexelSizes[MAX_CASCADES]; // world units per texel
+uniform int cascadeCount; // 0 when shadows are off
+uniform mat4 view;
+
+out vec4 FragColor;
+
+// what the lit shaders get from their inputs and material, read from the G-buffer
+vec3 FragPos;
+vec3 Albedo;
+float Specular;
+float Shininess;
+
+void main()
+{
+    // nothing was drawn here, the skybox stays
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth == 1.0)
+        discard;
+
+    vec4 clip = vec4(gl_FragCoord.xy / vec2(textureSize(gDepth, 0)), depth, 1.0) * 2.0 - 1.0;
+    vec4 world = inverseViewProjection * clip;
+    FragPos = world.xyz / world.w;
+
+    vec4 albedoSpecular = texelFetch(gAlbedoSpecular, pixel, 0);
+    Albedo = albedoSpecular.rgb;
+    Specular = albedoSpecular.a;
+
+    vec4 normalShininess = texelFetch(gNormal, pixel, 0);
+    vec3 norm = DecodeNormal(normalShininess.xy * 2.0 - 1.0);
+    Shininess = exp2(normalShininess.z * 11.0);
+    vec3 viewDir = normalize(viewPos - FragPos);
+
+    vec3 result = CalcDirLight(dirLight, norm, viewDir);
+    for(int i = 0; i < NR_SPOT_LIGHTS; i++)
+        result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);
+
+    FragColor = vec4(result, 1.0);
+    gl_FragDepth = depth;
+}
+
+vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
+{
+    vec3 lightDir = normalize(-light.direction);
+    float diff = max(dot(normal, lightDir), 0.0);
+
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Shininess);
+
+    vec3 ambientLight = skyAmbient ? SkyIrradiance(normal) * skyAmbientIntensity : light.ambient;
+    vec3 ambient  = ambientLight * Albedo;
+    vec3 diffuse  = light.diffuse  * diff * Albedo;
+    vec3 specular = light.specular * spec * Specular;
+
+    float shadow = CalcDirShadow(normal, lightDir);
+
+    return (ambient + shadow * (diffuse + specular));
+}
+
+float CalcDirShadow(vec3 normal, vec3 lightDir)
+{
+    // first cascade whose slice reaches this fragment
+    float depth = -(view * vec4(FragPos, 1.0)).z;
+    int cascade = 0;
+    while (cascade < cascadeCount && depth > cascadeSplits[cascade])
+        cascade++;
+    if (cascade == cascadeCount)
+        return 1.0;
+
+    // pushed out along the normal against acne, further at grazing angles
+    float slope = 1.0 - max(dot(normal, lightDir), 0.0);
+    vec3 position = FragPos + normal * cascadeTexelSizes[cascade] * (0.5 + 1.5 * slope);
+    vec3 coords = (cascadeMatrices[cascade] * vec4(position, 1.0)).xyz * 0.5 + 0.5;
+
+    // 3x3 taps, each one a bilinear 2x2 compare in hardware
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, cascade, coords.z));
+
+    return lit / 9.0;
+}
+
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+{    
+    vec3 lightDir = normalize(light.position - fragPos);
+    float theta = dot(lightDir, normalize(-light.direction));
+    float epsilon   = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);    
+
+    if(theta > light.outerCutOff) 
+    {       
+        float diff = max(dot(normal, lightDir), 0.0);
+        vec3 reflectDir = reflect(-lightDir, normal);
+        float spec = pow(max(dot(viewDir, reflectDir), 0.0), Shininess);
+
+        vec3 ambient  = light.ambient  * Albedo;
+        vec3 diffuse  = light.diffuse  * diff * Albedo;
+        vec3 specular = light.specular * spec * Specular;
+
+        diffuse *= intensity;
+        specular *= intensity;
+
+        return (ambient + diffuse + specular);
+    }
+    
+    return vec3(0.0f);
+}
+
+vec3 DecodeNormal(vec2 encoded)
+{
+    // inverse of EncodeNormal in the lit shaders, unfolds the lower half of the octahedron
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -fold : fold;
+    n.y += n.y >= 0.0 ? -fold : fold;
+    return normalize(n);
+}
+
+vec3 SkyIrradiance(vec3 n)
+{
+    return shCoefficients[0] * 0.282095
+        + shCoefficients[1] * (0.488603 * n.y)
+        + shCoefficients[2] * (0.488603 * n.z)
+        + shCoefficients[3] * (0.488603 * n.x)
+        + shCoefficients[4] * (1.092548 * n.x * n.y)
+        + shCoefficients[5] * (1.092548 * n.y * n.z)
+        + shCoefficients[6] * (0.315392 * (3.0 * n.z * n.z - 1.0))
+        + shCoefficients[7] * (1.092548 * n.x * n.z)
+        + shCoefficients[8] * (0.546274 * (n.x * n.x - n.y * n.y));
+}
\ No newline at end of file
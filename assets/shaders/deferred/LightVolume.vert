@@ -0,0 +1,33 @@
+#version 430 core
+// One instance per point light, scaled to its range. Drawn back faces only, depth
+// tested GL_GEQUAL against the scene, so only pixels in front of the far side of the
+// volume reach the fragment shader.
+layout (location = 0) in vec3 aPos; // circumscribes the unit sphere
+
+struct PointLight {    
+    vec4 position; // w: range
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation; // constant, linear, quadratic
+};
+
+// every point light in the scene, see PointLightData
+layout (std430, binding = 5) readonly buffer PointLights {
+    PointLight pointLights[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+flat out int LightIndex;
+
+void main()
+{
+    // lights without attenuation reach everything, depth clamp keeps the far side of their volume
+    PointLight light = pointLights[gl_InstanceID];
+    float range = min(light.position.w, 10000.0);
+
+    LightIndex = gl_InstanceID;
+    gl_Position = projection * view * vec4(light.position.xyz + aPos * range, 1.0);
+}
\ No newline at end of file
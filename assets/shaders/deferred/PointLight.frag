@@ -0,0 +1,135 @@
+#version 430 core
+// One point light of every pixel its volume covers, added onto what DirectionalLight.frag wrote.
+
+struct PointLight {    
+    vec4 position; // w: range
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation; // constant, linear, quadratic
+};
+
+// every point light in the scene, see PointLightData
+layout (std430, binding = 5) readonly buffer PointLights {
+    PointLight pointLights[];
+};
+
+// CalcPointShadow is the lit shaders', the loader has no includes: keep it identical to
+// lit/FragmentShader.frag
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow);  
+float CalcPointShadow(PointLight light, vec3 normal);
+vec3 DecodeNormal(vec2 encoded);
+
+// G-buffer, see DeferredRenderer
+uniform sampler2D gAlbedoSpecular; // rgb albedo, a specular intensity
+uniform sampler2D gNormal; // octahedral normal in rg, log2 of the shininess over 11 in b
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+uniform vec3 viewPos;
+
+// Cube shadow map of one point light, see PointShadowMap
+uniform samplerCubeShadow pointShadowMap;
+uniform int pointShadowLight; // index into pointLights, -1 when off
+uniform float pointShadowFar;
+uniform float pointShadowResolution;
+
+flat in int LightIndex;
+
+out vec4 FragColor;
+
+// what the lit shaders get from their inputs and material, read from the G-buffer
+vec3 FragPos;
+vec3 Albedo;
+float Specular;
+float Shininess;
+
+void main()
+{
+    // nothing was drawn here, the skybox stays
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    if (depth == 1.0)
+        discard;
+
+    vec4 clip = vec4(gl_FragCoord.xy / vec2(textureSize(gDepth, 0)), depth, 1.0) * 2.0 - 1.0;
+    vec4 world = inverseViewProjection * clip;
+    FragPos = world.xyz / world.w;
+
+    vec4 albedoSpecular = texelFetch(gAlbedoSpecular, pixel, 0);
+    Albedo = albedoSpecular.rgb;
+    Specular = albedoSpecular.a;
+
+    vec4 normalShininess = texelFetch(gNormal, pixel, 0);
+    vec3 norm = DecodeNormal(normalShininess.xy * 2.0 - 1.0);
+    Shininess = exp2(normalShininess.z * 11.0);
+    vec3 viewDir = normalize(viewPos - FragPos);
+
+    // the volume is coarser than the light's sphere
+    PointLight light = pointLights[LightIndex];
+    vec3 toLight = light.position.xyz - FragPos;
+    if (dot(toLight, toLight) >= light.position.w * light.position.w)
+        discard;
+
+    float shadow = LightIndex == pointShadowLight ? CalcPointShadow(light, norm) : 1.0;
+    FragColor = vec4(CalcPointLight(light, norm, FragPos, viewDir, shadow), 1.0);
+}
+
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
+{
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
+    float diff = max(dot(normal, lightDir), 0.0);
+
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), Shininess);
+
+    float distance    = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + 
+  			     light.attenuation.z * (distance * distance));    
+
+    vec3 ambient  = light.ambient.rgb  * Albedo;
+    vec3 diffuse  = light.diffuse.rgb  * diff * Albedo;
+    vec3 specular = light.specular.rgb * spec * Specular;
+    
+    ambient  *= attenuation;
+    diffuse  *= attenuation * shadow;
+    specular *= attenuation * shadow;
+    
+    return (ambient + diffuse + specular);
+}
+
+float CalcPointShadow(PointLight light, vec3 normal)
+{
+    // distance to the light over the far plane, what the cube stores
+    float distance = length(FragPos - light.position.xyz);
+    if (distance >= pointShadowFar)
+        return 1.0;
+
+    // normal offset of about a texel at this distance, against acne
+    vec3 position = FragPos + normal * (3.0 * distance / pointShadowResolution);
+    vec3 toFragment = position - light.position.xyz;
+    float reference = length(toFragment) / pointShadowFar;
+
+    // 4 taps around the direction, each one a bilinear compare in hardware
+    float spread = 1.5 / pointShadowResolution;
+    vec3 direction = normalize(toFragment);
+    vec3 tangent = normalize(cross(direction, abs(direction.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 bitangent = cross(direction, tangent);
+
+    float lit = 0.0;
+    lit += texture(pointShadowMap, vec4(direction + (tangent + bitangent) * spread, reference));
+    lit += texture(pointShadowMap, vec4(direction + (tangent - bitangent) * spread, reference));
+    lit += texture(pointShadowMap, vec4(direction - (tangent + bitangent) * spread, reference));
+    lit += texture(pointShadowMap, vec4(direction - (tangent - bitangent) * spread, reference));
+
+    return lit / 4.0;
+}
+
+vec3 DecodeNormal(vec2 encoded)
+{
+    // inverse of EncodeNormal in the lit shaders, unfolds the lower half of the octahedron
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float fold = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -fold : fold;
+    n.y += n.y >= 0.0 ? -fold : fold;
+    return normalize(n);
+}
\ No newline at end of file
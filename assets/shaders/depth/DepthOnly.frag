@@ -0,0 +1,6 @@
+#version 430 core
+// Depth is written by the fixed function, there is no color target.
+
+void main()
+{
+}
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 430 core
+// Position only, for depth passes that never shade.
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+// must match the lit pass bit for bit, it depth tests with GL_EQUAL. Every vertex shader
+// drawn over this pre-pass, or drawing it, declares the same
+invariant gl_Position;
+
+void main()
+{
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
\ No newline at end of file
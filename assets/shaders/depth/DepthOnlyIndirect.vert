@@ -0,0 +1,27 @@
+#version 430 core
+// Position only, transforms from the DrawData buffer like lit/VertexShaderIndirect.vert.
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in uint aDrawID;
+
+struct DrawData {
+    mat4 model;
+    vec4 scaleUV;
+    vec4 bounds;
+    vec4 color;
+    ivec4 lights;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+invariant gl_Position;
+
+void main()
+{
+    mat4 model = draws[aDrawID].model;
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#version 430 core
+// One level of the bloom chain: a 13-tap filter over the level above, four overlapping
+// 4x4 boxes and a centre one. The first level also drops what is below the threshold.
+uniform sampler2D source;
+uniform vec2 sourceTexelSize;
+uniform vec2 targetTexelSize;
+uniform float threshold; // negative past the first level
+
+out vec4 FragColor;
+
+vec3 Prefilter(vec3 color)
+{
+    // soft knee, half the threshold wide, so bloom fades in instead of popping
+    float brightness = max(color.r, max(color.g, color.b));
+    float knee = threshold * 0.5;
+    float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 0.0001);
+    return color * max(soft, brightness - threshold) / max(brightness, 0.0001);
+}
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy * targetTexelSize;
+    vec2 t = sourceTexelSize;
+
+    vec3 a = texture(source, uv + t * vec2(-2.0, -2.0)).rgb;
+    vec3 b = texture(source, uv + t * vec2( 0.0, -2.0)).rgb;
+    vec3 c = texture(source, uv + t * vec2( 2.0, -2.0)).rgb;
+    vec3 d = texture(source, uv + t * vec2(-2.0,  0.0)).rgb;
+    vec3 e = texture(source, uv).rgb;
+    vec3 f = texture(source, uv + t * vec2( 2.0,  0.0)).rgb;
+    vec3 g = texture(source, uv + t * vec2(-2.0,  2.0)).rgb;
+    vec3 h = texture(source, uv + t * vec2( 0.0,  2.0)).rgb;
+    vec3 i = texture(source, uv + t * vec2( 2.0,  2.0)).rgb;
+    vec3 j = texture(source, uv + t * vec2(-1.0, -1.0)).rgb;
+    vec3 k = texture(source, uv + t * vec2( 1.0, -1.0)).rgb;
+    vec3 l = texture(source, uv + t * vec2(-1.0,  1.0)).rgb;
+    vec3 m = texture(source, uv + t * vec2( 1.0,  1.0)).rgb;
+
+    vec3 color = e * 0.125 + (j + k + l + m) * 0.125;
+    color += (a + c + g + i) * 0.03125 + (b + d + f + h) * 0.0625;
+
+    if (threshold >= 0.0)
+        color = Prefilter(color);
+
+    FragColor = vec4(max(color, vec3(0.0)), 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#version 430 core
+// Tent filter over a smaller bloom level, added onto the next larger one by blending.
+uniform sampler2D source;
+uniform vec2 sourceTexelSize;
+uniform vec2 targetTexelSize;
+
+out vec4 FragColor;
+
+void main()
+{
+    vec2 uv = gl_FragCoord.xy * targetTexelSize;
+    vec2 t = sourceTexelSize;
+
+    vec3 color = texture(source, uv).rgb * 4.0;
+    color += (texture(source, uv + t * vec2( 0.0, -1.0)).rgb + texture(source, uv + t * vec2(-1.0,  0.0)).rgb
+        + texture(source, uv + t * vec2( 1.0,  0.0)).rgb + texture(source, uv + t * vec2( 0.0,  1.0)).rgb) * 2.0;
+    color += texture(source, uv + t * vec2(-1.0, -1.0)).rgb + texture(source, uv + t * vec2( 1.0, -1.0)).rgb
+        + texture(source, uv + t * vec2(-1.0,  1.0)).rgb + texture(source, uv + t * vec2( 1.0,  1.0)).rgb;
+
+    FragColor = vec4(color / 16.0, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#version 430 core
+// Exposure, bloom, ACES tonemapping and gamma, the last pass over the HDR scene.
+uniform sampler2D scene;
+uniform sampler2D bloomTexture;
+uniform bool bloom;
+uniform float bloomIntensity;
+uniform bool autoExposure;
+uniform float exposure; // 2^stops
+
+layout (std430, binding = 7) readonly buffer Exposure {
+    uint bins[256];
+    float luminance;
+};
+
+out vec4 FragColor;
+
+// Narkowicz fit of the ACES filmic curve
+vec3 ACESFilm(vec3 x)
+{
+    return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec3 color = texelFetch(scene, pixel, 0).rgb;
+
+    if (bloom)
+    {
+        vec2 uv = (vec2(pixel) + 0.5) / vec2(textureSize(scene, 0));
+        color += texture(bloomTexture, uv).rgb * bloomIntensity;
+    }
+
+    // auto-exposure maps the adapted luminance to middle grey
+    float scale = exposure;
+    if (autoExposure)
+        scale *= 0.18 / max(luminance, 0.0001);
+
+    color = ACESFilm(color * scale);
+    FragColor = vec4(pow(color, vec3(1.0 / 2.2)), 1.0);
+}
\ No newline at end of file
@@ -5,6 +5,8 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+invariant gl_Position;
+
 void main()
 {
     gl_Position = projection * view * model * vec4(aPos, 1.0);
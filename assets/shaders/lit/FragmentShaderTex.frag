@@ -16,15 +16,11 @@ struct DirLight {
 };  
 
 struct PointLight {    
-    vec3 position;
-    
-    float constant;
-    float linear;
-    float quadratic;  
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
+    vec4 position; // w: range
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    vec4 attenuation; // constant, linear, quadratic
 };
 
 struct SpotLight {
@@ -39,36 +35,113 @@ struct SpotLight {
 };  
 
 vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir);  
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir);  
+float CalcDirShadow(vec3 normal, vec3 lightDir);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow);  
+float CalcPointShadow(PointLight light, vec3 normal);
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir);  
+vec2 EncodeNormal(vec3 normal);
+vec3 SkyIrradiance(vec3 n);
 
 uniform vec2 uvscale;
 uniform DirLight dirLight;
-#define NR_POINT_LIGHTS 1
-uniform PointLight pointLights[NR_POINT_LIGHTS];
+
+// Diffuse light from the sky, its L2 spherical harmonics convolved with the cosine lobe,
+// see projectCubemap. Replaces the directional light's flat ambient with skyAmbient set.
+uniform vec3 shCoefficients[9];
+uniform bool skyAmbient;
+uniform float skyAmbientIntensity;
+
+#define MAX_OBJECT_LIGHTS 4
+// every point light in the scene, see PointLightData
+layout (std430, binding = 5) readonly buffer PointLights {
+    PointLight pointLights[];
+};
 #define NR_SPOT_LIGHTS 1
 uniform SpotLight spotLights[NR_SPOT_LIGHTS];
+
+// Forward+, see TiledLightCuller: the lights of this pixel's tile replace LightIndices
+#define TILE_SIZE 16
+#define MAX_TILE_LIGHTS 128
+struct LightTile {
+    uint pointCount;
+    uint spotMask; // bit per spot light
+    uint lights[MAX_TILE_LIGHTS]; // indices into pointLights
+};
+layout (std430, binding = 6) readonly buffer LightTiles {
+    LightTile tiles[];
+};
+uniform bool tiledLights;
+uniform int tileCountX;
   
 uniform Material material;
 uniform vec3 viewPos;
 
+// Cascaded shadow map of the directional light, see CascadedShadowMap
+#define MAX_CASCADES 4
+uniform sampler2DArrayShadow shadowMap;
+uniform mat4 cascadeMatrices[MAX_CASCADES];
+uniform float cascadeSplits[MAX_CASCADES]; // far end of every cascade, view-space distance
+uniform float cascadeTexelSizes[MAX_CASCADES]; // world units per texel
+uniform int cascadeCount; // 0 when shadows are off
+uniform mat4 view;
+
+// Cube shadow map of one point light, see PointShadowMap
+uniform samplerCubeShadow pointShadowMap;
+uniform int pointShadowLight; // index into pointLights, -1 when off
+uniform float pointShadowFar;
+uniform float pointShadowResolution;
+
 in vec3 Normal;
 in vec3 FragPos;  
 in vec2 TexCoords;
+flat in ivec4 LightIndices; // the point lights that reach this object, -1 past the last
+
+// Deferred path, see DeferredRenderer: the same shader fills the G-buffer instead of shading
+uniform bool gBufferPass;
 
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor; // albedo and specular intensity in the G-buffer pass
+layout (location = 1) out vec4 GBufferNormal; // octahedral normal and shininess, G-buffer pass only
 
 void main()
 {
-
     vec3 norm = normalize(Normal);
+    if (gBufferPass)
+    {
+        FragColor = vec4(vec3(texture(material.diffuse, TexCoords)), dot(vec3(texture(material.specularMap, TexCoords)), vec3(1.0 / 3.0)));
+        // shininess up to 2048 as its log2, 10 bits keep it within 1%
+        GBufferNormal = vec4(EncodeNormal(norm) * 0.5 + 0.5, log2(material.shininess) / 11.0, 0.0);
+        return;
+    }
+
     vec3 viewDir = normalize(viewPos - FragPos);
 
     vec3 result = CalcDirLight(dirLight, norm, viewDir);
-    for(int i = 0; i < NR_POINT_LIGHTS; i++)
-        result += CalcPointLight(pointLights[i], norm, FragPos, viewDir);    
+    uint spotMask = 0xFFFFFFFFu;
+    if (tiledLights)
+    {
+        uint tile = uint(gl_FragCoord.y) / TILE_SIZE * uint(tileCountX) + uint(gl_FragCoord.x) / TILE_SIZE;
+        for(uint i = 0u; i < tiles[tile].pointCount; i++)
+        {
+            int light = int(tiles[tile].lights[i]);
+            float shadow = light == pointShadowLight ? CalcPointShadow(pointLights[light], norm) : 1.0;
+            result += CalcPointLight(pointLights[light], norm, FragPos, viewDir, shadow);
+        }
+        spotMask = tiles[tile].spotMask;
+    }
+    else
+    {
+        for(int i = 0; i < MAX_OBJECT_LIGHTS && LightIndices[i] >= 0; i++)
+        {
+            int light = LightIndices[i];
+            float shadow = light == pointShadowLight ? CalcPointShadow(pointLights[light], norm) : 1.0;
+            result += CalcPointLight(pointLights[light], norm, FragPos, viewDir, shadow);
+        }
+    }
     for(int i = 0; i < NR_SPOT_LIGHTS; i++)
-        result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);    
+    {
+        if ((spotMask & (1u << i)) != 0u)
+            result += CalcSpotLight(spotLights[i], norm, FragPos, viewDir);
+    }
     
     FragColor = vec4(result, 1.0);
 }
@@ -81,36 +154,91 @@ vec3 CalcDirLight(DirLight light, vec3 normal, vec3 viewDir)
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
 
-    vec3 ambient  = light.ambient  * vec3(texture(material.diffuse, TexCoords));
+    vec3 ambientLight = skyAmbient ? SkyIrradiance(normal) * skyAmbientIntensity : light.ambient;
+    vec3 ambient  = ambientLight * vec3(texture(material.diffuse, TexCoords));
     vec3 diffuse  = light.diffuse  * diff * vec3(texture(material.diffuse, TexCoords));
     vec3 specular = light.specular * spec * vec3(texture(material.specularMap, TexCoords));
 
-    return (ambient + diffuse + specular);
-}  
+    float shadow = CalcDirShadow(normal, lightDir);
+
+    return (ambient + shadow * (diffuse + specular));
+}
 
-vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
+float CalcDirShadow(vec3 normal, vec3 lightDir)
 {
-    vec3 lightDir = normalize(light.position - fragPos);
+    // first cascade whose slice reaches this fragment
+    float depth = -(view * vec4(FragPos, 1.0)).z;
+    int cascade = 0;
+    while (cascade < cascadeCount && depth > cascadeSplits[cascade])
+        cascade++;
+    if (cascade == cascadeCount)
+        return 1.0;
+
+    // pushed out along the normal against acne, further at grazing angles
+    float slope = 1.0 - max(dot(normal, lightDir), 0.0);
+    vec3 position = FragPos + normal * cascadeTexelSizes[cascade] * (0.5 + 1.5 * slope);
+    vec3 coords = (cascadeMatrices[cascade] * vec4(position, 1.0)).xyz * 0.5 + 0.5;
+
+    // 3x3 taps, each one a bilinear 2x2 compare in hardware
+    vec2 texel = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    float lit = 0.0;
+    for (int x = -1; x <= 1; x++)
+        for (int y = -1; y <= 1; y++)
+            lit += texture(shadowMap, vec4(coords.xy + vec2(x, y) * texel, cascade, coords.z));
+
+    return lit / 9.0;
+}
+
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, float shadow)
+{
+    vec3 lightDir = normalize(light.position.xyz - fragPos);
     float diff = max(dot(normal, lightDir), 0.0);
 
     vec3 reflectDir = reflect(-lightDir, normal);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
 
-    float distance    = length(light.position - fragPos);
-    float attenuation = 1.0 / (light.constant + light.linear * distance + 
-  			     light.quadratic * (distance * distance));    
+    float distance    = length(light.position.xyz - fragPos);
+    float attenuation = 1.0 / (light.attenuation.x + light.attenuation.y * distance + 
+  			     light.attenuation.z * (distance * distance));    
 
-    vec3 ambient  = light.ambient  * vec3(texture(material.diffuse, TexCoords));
-    vec3 diffuse  = light.diffuse  * diff * vec3(texture(material.diffuse, TexCoords));
-    vec3 specular = light.specular * spec * vec3(texture(material.specularMap, TexCoords));
+    vec3 ambient  = light.ambient.rgb  * vec3(texture(material.diffuse, TexCoords));
+    vec3 diffuse  = light.diffuse.rgb  * diff * vec3(texture(material.diffuse, TexCoords));
+    vec3 specular = light.specular.rgb * spec * vec3(texture(material.specularMap, TexCoords));
     
     ambient  *= attenuation;
-    diffuse  *= attenuation;
-    specular *= attenuation;
+    diffuse  *= attenuation * shadow;
+    specular *= attenuation * shadow;
     
     return (ambient + diffuse + specular);
 } 
 
+float CalcPointShadow(PointLight light, vec3 normal)
+{
+    // distance to the light over the far plane, what the cube stores
+    float distance = length(FragPos - light.position.xyz);
+    if (distance >= pointShadowFar)
+        return 1.0;
+
+    // normal offset of about a texel at this distance, against acne
+    vec3 position = FragPos + normal * (3.0 * distance / pointShadowResolution);
+    vec3 toFragment = position - light.position.xyz;
+    float reference = length(toFragment) / pointShadowFar;
+
+    // 4 taps around the direction, each one a bilinear compare in hardware
+    float spread = 1.5 / pointShadowResolution;
+    vec3 direction = normalize(toFragment);
+    vec3 tangent = normalize(cross(direction, abs(direction.y) < 0.99 ? vec3(0.0, 1.0, 0.0) : vec3(1.0, 0.0, 0.0)));
+    vec3 bitangent = cross(direction, tangent);
+
+    float lit = 0.0;
+    lit += texture(pointShadowMap, vec4(direction + (tangent + bitangent) * spread, reference));
+    lit += texture(pointShadowMap, vec4(direction + (tangent - bitangent) * spread, reference));
+    lit += texture(pointShadowMap, vec4(direction - (tangent + bitangent) * spread, reference));
+    lit += texture(pointShadowMap, vec4(direction - (tangent - bitangent) * spread, reference));
+
+    return lit / 4.0;
+}
+
 vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 {    
     vec3 lightDir = normalize(light.position - fragPos);
@@ -137,4 +265,26 @@ vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
     }
     
     return vec3(0.0f);
-} 
\ No newline at end of file
+}
+
+vec2 EncodeNormal(vec3 normal)
+{
+    // onto the octahedron |x| + |y| + |z| = 1, the lower half folded over the upper
+    vec3 n = normal / (abs(normal.x) + abs(normal.y) + abs(normal.z));
+    if (n.z < 0.0)
+        n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return n.xy;
+}
+
+vec3 SkyIrradiance(vec3 n)
+{
+    return shCoefficients[0] * 0.282095
+        + shCoefficients[1] * (0.488603 * n.y)
+        + shCoefficients[2] * (0.488603 * n.z)
+        + shCoefficients[3] * (0.488603 * n.x)
+        + shCoefficients[4] * (1.092548 * n.x * n.y)
+        + shCoefficients[5] * (1.092548 * n.y * n.z)
+        + shCoefficients[6] * (0.315392 * (3.0 * n.z * n.z - 1.0))
+        + shCoefficients[7] * (1.092548 * n.x * n.z)
+        + shCoefficients[8] * (0.546274 * (n.x * n.x - n.y * n.y));
+}
\ No newline at end of file
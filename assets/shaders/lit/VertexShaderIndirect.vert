@@ -0,0 +1,47 @@
+#version 430 core
+// Per-draw transforms come from the DrawData buffer instead of uniforms.
+// aDrawID is instanced and each command starts at its own baseInstance,
+// so it is the index of the draw inside the multi-draw.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in uint aDrawID;
+
+struct DrawData {
+    mat4 model;
+    vec4 scaleUV;
+    vec4 bounds;
+    vec4 color;
+    ivec4 lights;
+};
+
+layout (std430, binding = 0) readonly buffer Draws {
+    DrawData draws[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+out vec3 Normal;
+out vec3 FragPos; 
+out vec2 TexCoords;
+out vec3 DiffuseColor;
+flat out ivec4 LightIndices;
+
+invariant gl_Position;
+
+void main()
+{
+    mat4 model = draws[aDrawID].model;
+    vec2 scaleUV = draws[aDrawID].scaleUV.xy;
+
+    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = mat3(transpose(inverse(model))) * normalize(aNormal);  
+    if(length(scaleUV) == 0)
+        TexCoords = aTexCoords;
+    else
+        TexCoords = (aTexCoords) * scaleUV;
+    DiffuseColor = draws[aDrawID].color.rgb;
+    LightIndices = draws[aDrawID].lights;
+}
\ No newline at end of file
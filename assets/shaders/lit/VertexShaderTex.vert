@@ -1,24 +1,36 @@
 #version 430 core
+// Positions may arrive as snorm16, normals as 2_10_10_10 and texCoords as halves,
+// the attribute fetch unpacks them to float. Packed normals lose unit length.
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aTexCoords;
 
-uniform mat4 model;
+// per-object data, streamed once per draw instead of set as uniforms
+layout (std140, binding = 1) uniform ObjectData {
+    mat4 model;
+    vec4 scaleUV;
+    vec4 color;
+    ivec4 lights;
+};
+
 uniform mat4 view;
 uniform mat4 projection;
-uniform vec2 scaleUV;
 
 out vec3 Normal;
 out vec3 FragPos; 
 out vec2 TexCoords;
+flat out ivec4 LightIndices;
+
+invariant gl_Position;
 
 void main()
 {
     gl_Position = projection * view * model * vec4(aPos, 1.0);
     FragPos = vec3(model * vec4(aPos, 1.0));
-    Normal = mat3(transpose(inverse(model))) * aNormal;  
-    if(length(scaleUV) == 0)
+    Normal = mat3(transpose(inverse(model))) * normalize(aNormal);  
+    if(length(scaleUV.xy) == 0)
         TexCoords = aTexCoords;
     else
-        TexCoords = (aTexCoords) * scaleUV;
+        TexCoords = (aTexCoords) * scaleUV.xy;
+    LightIndices = lights;
 } 
\ No newline at end of file
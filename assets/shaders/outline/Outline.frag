@@ -0,0 +1,33 @@
+#version 430 core
+
+uniform sampler2D mask;
+uniform vec3 color;
+uniform int width;
+
+out vec4 FragColor;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    if (texelFetch(mask, pixel, 0).r > 0.5)
+        discard;
+
+    ivec2 maxPixel = textureSize(mask, 0) - 1;
+    for (int y = -width; y <= width; y++)
+    {
+        for (int x = -width; x <= width; x++)
+        {
+            if (x * x + y * y > width * width)
+                continue;
+
+            ivec2 neighbour = clamp(pixel + ivec2(x, y), ivec2(0), maxPixel);
+            if (texelFetch(mask, neighbour, 0).r > 0.5)
+            {
+                FragColor = vec4(color, 1.0);
+                return;
+            }
+        }
+    }
+
+    discard;
+}
\ No newline at end of file
@@ -0,0 +1,8 @@
+#version 430 core
+// Every fragment adds one, blended with GL_ONE, GL_ONE.
+out vec4 FragColor;
+
+void main()
+{
+    FragColor = vec4(1.0, 0.0, 0.0, 0.0);
+}
\ No newline at end of file
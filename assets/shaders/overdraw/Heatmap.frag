@@ -0,0 +1,28 @@
+#version 430 core
+
+uniform sampler2D counts;
+uniform float maxCount;
+
+out vec4 FragColor;
+
+// black, blue, green, yellow, red, white at and above maxCount
+vec3 heat(float t)
+{
+    const vec3 ramp[6] = vec3[](
+        vec3(0.0, 0.0, 0.0),
+        vec3(0.0, 0.0, 1.0),
+        vec3(0.0, 1.0, 0.0),
+        vec3(1.0, 1.0, 0.0),
+        vec3(1.0, 0.0, 0.0),
+        vec3(1.0, 1.0, 1.0));
+
+    float x = clamp(t, 0.0, 1.0) * 5.0;
+    int i = min(int(x), 4);
+    return mix(ramp[i], ramp[i + 1], x - float(i));
+}
+
+void main()
+{
+    float count = texelFetch(counts, ivec2(gl_FragCoord.xy), 0).r;
+    FragColor = vec4(heat(count / maxCount), 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 430 core
+// Instanced depth for one cascade, every instance reads its own model matrix.
+layout (location = 0) in vec3 aPos;
+
+layout (std430, binding = 4) readonly buffer CasterModels {
+    mat4 models[];
+};
+
+uniform mat4 lightSpaceMatrix;
+uniform int baseModel; // first model of this draw, gl_BaseInstance needs GL 4.6
+
+void main()
+{
+    gl_Position = lightSpaceMatrix * models[baseModel + gl_InstanceID] * vec4(aPos, 1.0);
+}
\ No newline at end of file
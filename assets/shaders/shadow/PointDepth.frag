@@ -0,0 +1,11 @@
+#version 430 core
+// Linear distance to the light, so lookups compare distances instead of depths.
+in vec3 FragPos;
+
+uniform vec3 lightPosition;
+uniform float farPlane;
+
+void main()
+{
+    gl_FragDepth = length(FragPos - lightPosition) / farPlane;
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#version 430 core
+// World-space positions for the cube geometry shader, one caster per instance.
+layout (location = 0) in vec3 aPos;
+
+struct ShadowCaster {
+    mat4 model;
+    uint faceMask;
+};
+
+layout (std430, binding = 4) readonly buffer PointCasters {
+    ShadowCaster casters[];
+};
+
+uniform int baseCaster; // first caster of this draw, gl_BaseInstance needs GL 4.6
+
+flat out uint FaceMask;
+
+void main()
+{
+    ShadowCaster caster = casters[baseCaster + gl_InstanceID];
+    FaceMask = caster.faceMask;
+    gl_Position = caster.model * vec4(aPos, 1.0);
+}
\ No newline at end of file
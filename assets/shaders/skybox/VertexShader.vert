@@ -1,16 +1,15 @@
 #version 430 core
-layout (location = 0) in vec3 aPos;
-
+// One triangle over the screen, at the far plane so only pixels nothing was drawn on
+// pass the LEQUAL test. The direction through every corner is unprojected, it stays
+// linear across the screen and the cube map lookup ignores its length.
 out vec3 TexCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+uniform mat4 inverseViewProjection; // without the view's translation
 
 void main()
 {
-    mat4 viewNoTranslation = mat4(mat3(view));
-
-    TexCoords = aPos;
-    gl_Position = projection * viewNoTranslation * vec4(aPos, 1.0);
-}  
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
 
+    TexCoords = (inverseViewProjection * vec4(position, 1.0, 1.0)).xyz;
+    gl_Position = vec4(position, 1.0, 1.0);
+}
\ No newline at end of file
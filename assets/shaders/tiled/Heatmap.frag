@@ -0,0 +1,46 @@
+#version 430 core
+// Point lights per Forward+ tile over the scene, see TiledLightCuller.
+#define TILE_SIZE 16
+#define MAX_TILE_LIGHTS 128
+
+struct LightTile {
+    uint pointCount;
+    uint spotMask; // bit per spot light
+    uint lights[MAX_TILE_LIGHTS]; // indices into pointLights
+};
+
+layout (std430, binding = 6) readonly buffer LightTiles {
+    LightTile tiles[];
+};
+
+uniform int tileCountX;
+uniform float maxCount;
+
+out vec4 FragColor;
+
+// black, blue, green, yellow, red, white at and above maxCount
+vec3 heat(float t)
+{
+    const vec3 ramp[6] = vec3[](
+        vec3(0.0, 0.0, 0.0),
+        vec3(0.0, 0.0, 1.0),
+        vec3(0.0, 1.0, 0.0),
+        vec3(1.0, 1.0, 0.0),
+        vec3(1.0, 0.0, 0.0),
+        vec3(1.0, 1.0, 1.0));
+
+    float x = clamp(t, 0.0, 1.0) * 5.0;
+    int i = min(int(x), 4);
+    return mix(ramp[i], ramp[i + 1], x - float(i));
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 tile = pixel / TILE_SIZE;
+    float count = float(tiles[tile.y * tileCountX + tile.x].pointCount);
+
+    // half over the scene, a little stronger on the tile borders
+    bool border = any(equal(pixel % TILE_SIZE, ivec2(0)));
+    FragColor = vec4(heat(count / maxCount), border ? 0.75 : 0.5);
+}
\ No newline at end of file
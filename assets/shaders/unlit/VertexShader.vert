@@ -1,5 +1,6 @@
 #version 430 core
 
+// snorm16 positions are unpacked to float by the attribute fetch
 layout(location = 0) in vec3 aPos;
 
 uniform mat4 model;
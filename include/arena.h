@@ -0,0 +1,174 @@
+#pragma once
+
+#include "mesh.h"
+#include "objects.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class HiZBuffer;
+class StreamBuffer;
+
+// Layout fixed by glMultiDrawElementsIndirect.
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// One vertex buffer, one 16-bit index buffer and one VAO shared by every mesh
+// added to it, so any mix of meshes can go out in a single multi-draw.
+// Buffers grow by doubling, the VAO is re-pointed whenever they move.
+class GeometryArena
+{
+public:
+    GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    // Both need a current GL context.
+    void Init(VertexFormat format_, unsigned int vertexCapacity_ = 1 << 16, unsigned int indexCapacity_ = 1 << 18);
+    void Release();
+
+    // Forgets every range, the buffers are kept for reuse.
+    void Reset(VertexFormat format_);
+
+    // Fails for meshes with more vertices than a 16-bit index can reach.
+    bool Add(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, ArenaRange& range);
+
+    // Instanced attribute 3 holds 0, 1, 2, ... so a command's baseInstance reaches
+    // the shader as its draw index. gl_DrawID needs GL 4.6.
+    void ReserveDrawIDs(unsigned int drawCount);
+
+    void Bind() const;
+
+    VertexFormat GetFormat() const;
+    unsigned int GetVertexBytes() const;
+    unsigned int GetIndexBytes() const;
+    unsigned int GetRangeCount() const;
+
+private:
+    VertexFormat format;
+
+    unsigned int VAO;
+    unsigned int VBO;
+    unsigned int EBO;
+    unsigned int drawIDBuffer;
+
+    unsigned int vertexCapacity; // in vertices
+    unsigned int indexCapacity;
+    unsigned int drawIDCapacity;
+    unsigned int vertexCount;
+    unsigned int indexCount;
+    unsigned int rangeCount;
+
+    void grow(unsigned int& buffer, unsigned int usedBytes, unsigned int newBytes);
+    void setupVertexArray();
+};
+
+// Per-draw data read by the indirect vertex shaders, std430 layout.
+struct DrawData {
+    glm::mat4 model;
+    glm::vec4 scaleUV; // xy, zw unused
+    glm::vec4 bounds; // world-space bounding sphere, center and radius
+    glm::vec4 color; // rgb, ignored by textured shaders
+    glm::ivec4 lights; // point light indices, -1 past the last
+};
+
+// Input of the culling pass, std430 layout. Visible commands are appended
+// from batchFirst on, at the slot handed out by their batch's counter.
+struct CullCommand {
+    DrawElementsIndirectCommand command;
+    GLuint batch;
+    GLuint batchFirst;
+    GLuint padding;
+};
+
+// Collects draws from the arena into batches that share a shader and textures, then
+// uploads every command and DrawData once and issues one multi-draw per batch.
+// Given a StreamBuffer, the per-frame uploads are written into it instead of
+// reallocating buffers of their own every frame.
+// With gpuCulling a compute pass frustum-tests every draw and compacts the visible
+// ones to the front of their batch. Without glMultiDrawElementsIndirectCount (GL 4.6)
+// the draw count stays fixed, the slots left over are zeroed and draw nothing.
+// Given a built HiZBuffer, draws hidden behind its occluders are dropped as well.
+class IndirectRenderer
+{
+public:
+    static const int COUNTER_FRAMES = 4; // more than the frames the GPU can fall behind
+
+    IndirectRenderer();
+
+    IndirectRenderer(const IndirectRenderer&) = delete;
+    IndirectRenderer& operator=(const IndirectRenderer&) = delete;
+
+    bool gpuCulling;
+    bool occlusionCulling; // only with gpuCulling
+
+    void Init();
+    void Release();
+
+    void SetStreamBuffer(StreamBuffer* streamBuffer_);
+
+    void Clear();
+    // Fails when the mesh isn't in the arena, the caller draws it the old way.
+    bool Add(Object3D& object, const Mesh& mesh, Shader& shader);
+    // Uploads the draws and runs the culling pass, once per frame before any Draw. The
+    // pass writes the commands as storage, Draw needs a GL_COMMAND_BARRIER_BIT first.
+    void Prepare(const glm::mat4& viewProjection, const HiZBuffer* hiZ = nullptr);
+    void Draw(GeometryArena& arena);
+    // Geometry only, for passes that bring their own shader and state.
+    void DrawGeometry(GeometryArena& arena, Shader& shader);
+
+    unsigned int GetDrawCount() const;
+    unsigned int GetBatchCount() const;
+    // Read back a few frames late, once their pass is done, so the counters never stall the pipeline.
+    unsigned int GetVisibleCount() const;
+    unsigned int GetFrustumCulledCount() const;
+    unsigned int GetOccludedCount() const;
+
+private:
+    struct Batch {
+        Shader* shader;
+        unsigned int texture1, texture2, texture3;
+        std::vector<DrawElementsIndirectCommand> commands;
+        std::vector<DrawData> draws;
+    };
+
+    std::vector<Batch> batches;
+    unsigned int batchCount; // batches past this are empty and kept for their allocations
+    unsigned int drawCount;
+
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawData> draws;
+    std::vector<CullCommand> cullCommands;
+    std::vector<GLuint> counters;
+
+    Shader cullShader;
+    unsigned int commandBuffer;
+    unsigned int drawBuffer;
+    unsigned int cullBuffer;
+    // a ring of counter buffers, each fenced after the culling pass that writes it
+    unsigned int counterBuffers[COUNTER_FRAMES];
+    GLsync counterFences[COUNTER_FRAMES];
+    unsigned int counterBatchCounts[COUNTER_FRAMES]; // batches the slot's pass counted
+    int counterSlot; // written by the next culling pass
+
+    StreamBuffer* streamBuffer;
+    // where this frame's uploads landed in the stream buffer, -1 when in our own
+    GLintptr drawOffset;
+    GLintptr commandOffset;
+
+    unsigned int visibleCount;
+    unsigned int frustumCulledCount;
+    unsigned int occludedCount;
+
+    void bindBuffers(GeometryArena& arena);
+    void cull(const glm::mat4& viewProjection, const HiZBuffer* hiZ);
+};
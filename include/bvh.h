@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <vector>
+
+// 32 bytes, two nodes per cache line. Children are always allocated as a pair,
+// so an inner node only stores the index of its left child.
+struct BVHNode {
+    glm::vec3 min;
+    int leftFirst; // left child for inner nodes, first entry of items for leaves
+    glm::vec3 max;
+    int count; // 0 for inner nodes
+
+    bool isLeaf() const;
+};
+
+class BVH
+{
+public:
+    BVH();
+
+    // Binned SAH build over item bounds, item i keeps index i in every query.
+    void Build(const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs);
+
+    // Moves one item and refits only the nodes above it.
+    void UpdateItem(int item, const glm::vec3& min, const glm::vec3& max);
+    // Moves one item without touching the nodes, follow up with Refit().
+    void SetItem(int item, const glm::vec3& min, const glm::vec3& max);
+    void Refit();
+
+    // `intersect` tests one item against the ray and shortens maxT on a hit.
+    bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float& maxT,
+        const std::function<bool(int item, float& maxT)>& intersect) const;
+
+    void QueryAABB(const glm::vec3& min, const glm::vec3& max, std::vector<int>& results) const;
+    void QuerySphere(const glm::vec3& center, float radius, std::vector<int>& results) const;
+
+    unsigned int GetNodeCount() const;
+    unsigned int GetItemCount() const;
+    const BVHNode& GetRoot() const;
+    float GetRootArea() const;
+
+private:
+    std::vector<BVHNode> nodes;
+    std::vector<int> parents;
+    std::vector<int> items;
+    std::vector<int> itemLeaf;
+
+    std::vector<glm::vec3> itemMin;
+    std::vector<glm::vec3> itemMax;
+    std::vector<glm::vec3> centroids;
+
+    void updateNodeBounds(int nodeIndex);
+    void subdivide(int nodeIndex, int depth);
+    float findBestSplit(const BVHNode& node, int& axis, float& splitPosition) const;
+};
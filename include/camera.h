@@ -4,6 +4,9 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+// Left, right, bottom, top, near, far, normals point inwards and are unit length.
+void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]);
+
 enum CameraMovement {
     FORWARD,
     BACKWARD,
@@ -37,6 +40,7 @@ public:
     Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch);
 
     glm::mat4 GetViewMatrix();
+    glm::vec3 ScreenPointToRay(float x, float y, float width, float height, const glm::mat4& projection);
 
     void ProcessKeyboard(CameraMovement direction, float deltaTime);
     void ProcessMouseMovement(float xoffset, float yoffset, GLboolean constrainPitch = true);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "rendertargets.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+// Alternative to shading in the opaque passes. The lit shaders, with gBufferPass set,
+// write albedo, specular intensity, shininess and an octahedral normal into a G-buffer
+// in one geometry pass, and lighting reads it back once per covered pixel: the
+// directional and spot lights in a fullscreen pass, the point lights as instanced
+// volumes, so a light costs the pixels its range reaches instead of every fragment of
+// every object it touches. Both write into the framebuffer bound before, along with the scene's depth,
+// so the skybox behind and everything drawn forward afterwards compose with it. The
+// G-buffer's targets are the caller's, transient ones from a RenderGraph.
+class DeferredRenderer
+{
+public:
+    // 8 bytes of color per pixel. Albedo is linear since color maps are decoded when
+    // sampled, sRGB keeps 8 bits from banding in the darks, and specular intensity goes
+    // in its linear alpha. 10 bits per axis are plenty for a normal once octahedral
+    // encoding spreads them evenly over the sphere, the third holds the shininess.
+    static const GLenum ALBEDO_FORMAT = GL_SRGB8_ALPHA8;
+    static const GLenum NORMAL_FORMAT = GL_RGB10_A2;
+
+    DeferredRenderer();
+
+    DeferredRenderer(const DeferredRenderer&) = delete;
+    DeferredRenderer& operator=(const DeferredRenderer&) = delete;
+
+    // Both need a current GL context.
+    void Init();
+    void Release();
+
+    // Binds and clears the G-buffer: `albedo` in ALBEDO_FORMAT with depth, `normal` in
+    // NORMAL_FORMAT, both the size of the screen. The caller draws the opaque geometry
+    // in between, depth pre-pass included.
+    void BeginGeometry(const RenderTarget& albedo, const RenderTarget& normal);
+    void EndGeometry();
+
+    // Shades the last G-buffer into the previous framebuffer, its targets must still be
+    // alive. The lighting shaders take the
+    // same light and shadow uniforms as the lit shaders, and the point lights are read
+    // from the light buffer at POINT_LIGHT_BINDING.
+    void Light(const glm::mat4& view, const glm::mat4& projection, unsigned int pointLightCount);
+
+    Shader& GetDirectionalShader(); // ambient, directional and spot lights
+    Shader& GetPointShader(); // point light volumes
+
+    unsigned int GetVolumeCount() const;
+
+private:
+    Shader directionalShader;
+    Shader pointShader;
+
+    unsigned int FBO; // the targets' textures, attached as they change
+    unsigned int albedoTexture; // rgb albedo, a specular intensity
+    unsigned int normalTexture; // rg octahedral normal, b shininess
+    unsigned int depthTexture;
+    unsigned int emptyVAO;
+    unsigned int volumeVAO;
+    unsigned int volumeVBO;
+    unsigned int volumeEBO;
+    int width;
+    int height;
+
+    unsigned int volumeCount;
+
+    int targetFBO;
+    int targetViewport[4];
+
+    void bindGBuffer(Shader& shader, const glm::mat4& view, const glm::mat4& projection);
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// GPU time of a span of GL commands, from GL_TIME_ELAPSED queries read back a few
+// frames late so reading them never stalls. Spans can't nest or overlap, only one
+// time query can be active at once.
+class GpuTimer
+{
+public:
+    static const int QUERY_COUNT = 4; // more than the frames the GPU can fall behind
+
+    GpuTimer();
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    // Both need a current GL context.
+    void Init();
+    void Release();
+
+    void Begin();
+    void End();
+
+    float GetTime() const; // milliseconds, the latest span read back
+
+private:
+    unsigned int queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int current;
+    float time;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "rendertargets.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+// The scene is rendered into an RGBA16F target and brought to the screen by one fused
+// pass: exposure, optional bloom, ACES tonemapping and gamma. Auto-exposure comes from
+// a 256-bin log-luminance histogram built by a compute pass and averaged by a second,
+// which also adapts the exposure over time, all on the GPU without a readback. Bloom is
+// a chain of half-sized targets, downsampled from the bright parts of the scene and
+// added back up. The scene target and the bloom chain are the caller's, transient
+// targets from a RenderGraph.
+class HDRPipeline
+{
+public:
+    static const int HISTOGRAM_BINS = 256;
+    static const int MAX_BLOOM_LEVELS = 6;
+    static const GLenum BLOOM_FORMAT = GL_R11F_G11F_B10F; // only the light, not its alpha, at 4 bytes a pixel
+
+    bool autoExposure;
+    float exposureCompensation; // stops, the exposure itself without autoExposure
+    float adaptationSpeed; // per second, higher adapts faster
+    float minLogLuminance; // log2 luminance range the histogram covers
+    float maxLogLuminance;
+
+    bool bloom;
+    float bloomThreshold; // scene luminance where bloom starts
+    float bloomIntensity;
+    int bloomLevels;
+
+    HDRPipeline();
+
+    HDRPipeline(const HDRPipeline&) = delete;
+    HDRPipeline& operator=(const HDRPipeline&) = delete;
+
+    // Both need a current GL context.
+    void Init();
+    void Release();
+
+    // The bloom chain of a scene this size, from half its size halving down, bloomLevels
+    // at most. Writes the sizes of the levels and returns how many, 0 with bloom off.
+    int GetBloomLevels(int sceneWidth, int sceneHeight, int* widths, int* heights) const;
+    // Downsamples the bright parts of `scene` through `levels`, BLOOM_FORMAT targets of
+    // the sizes GetBloomLevels gave, and adds them back up, leaving the bloom in the first.
+    void RenderBloom(const RenderTarget& scene, const RenderTarget* levels, int levelCount);
+
+    // Tonemaps `scene`, with `bloom` added when there is one, into the framebuffer that
+    // is bound, over its viewport.
+    void Resolve(const RenderTarget& scene, const RenderTarget* bloom, float deltaTime);
+
+private:
+    Shader histogramShader;
+    Shader exposureShader;
+    Shader downsampleShader;
+    Shader upsampleShader;
+    Shader tonemapShader;
+
+    unsigned int exposureBuffer; // histogram bins, then the adapted luminance
+    unsigned int emptyVAO;
+
+    void measureLuminance(const RenderTarget& scene, float deltaTime);
+    void drawFullscreen(const RenderTarget& destination);
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "objects.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+// Occluders are drawn into a depth-only target, then reduced by compute passes into
+// an R32F mip chain where every texel holds the farthest depth below it. The culling
+// shader tests next frame's draws against it, see SoftwareOcclusion for the same
+// test on the CPU.
+class HiZBuffer
+{
+public:
+    HiZBuffer();
+
+    HiZBuffer(const HiZBuffer&) = delete;
+    HiZBuffer& operator=(const HiZBuffer&) = delete;
+
+    // Both need a current GL context.
+    void Init(int screenWidth, int screenHeight);
+    void Release();
+
+    void Resize(int screenWidth, int screenHeight);
+
+    // Binds the depth target, AddOccluder draws into it until EndDepthPass
+    // restores the previous framebuffer and builds the pyramid. The pyramid is
+    // written with image stores, sampling it needs a GL_TEXTURE_FETCH_BARRIER_BIT.
+    void BeginDepthPass(const glm::mat4& view, const glm::mat4& projection);
+    void AddOccluder(Object3D* object);
+    void EndDepthPass();
+
+    // False until the first pyramid is built, and again after a resize.
+    bool IsValid() const;
+
+    unsigned int GetTexture() const;
+    int GetWidth() const;
+    int GetHeight() const;
+    int GetLevelCount() const;
+    const glm::mat4& GetViewProjection() const; // the pyramid was rendered with it
+    unsigned int GetOccluderCount() const;
+
+private:
+    Shader depthShader;
+    Shader copyShader;
+    Shader downsampleShader;
+
+    unsigned int FBO;
+    unsigned int depthTexture;
+    unsigned int pyramidTexture;
+    int width;
+    int height;
+    int levelCount;
+
+    glm::mat4 viewProjection;
+    bool valid;
+    unsigned int occluderCount;
+
+    int targetFBO;
+    int targetViewport[4];
+
+    void buildPyramid();
+};
@@ -4,48 +4,122 @@
 #include <functional>
 
 #include <array>
-#include <unordered_map>
+#include <bitset>
+#include <vector>
 
 enum InputEventType {
 	JUST_PRESSED,
 	JUST_RELEASED,
-	PRESSED
+	PRESSED,
+	INPUT_EVENT_TYPE_COUNT
 };
 
-struct KeyState {
-	bool current = false;
-	bool previous = false;
-
-	bool justPressed() const;
-	bool justReleased() const;
-	bool pressed() const;
+enum InputSource : unsigned char {
+	INPUT_KEY,
+	INPUT_MOUSE_BUTTON,
+	INPUT_CURSOR,
+	INPUT_SCROLL
 };
 
-struct ActionBinding {
-	int key;
-	InputEventType type;
-
-	bool operator==(const ActionBinding& other) const;
+// Something the window reported, and the Process call it was applied in. Cursor
+// positions and scroll offsets are narrowed to float live as well, so a replay hands
+// the camera the very numbers the recorded run did.
+struct InputEvent {
+	unsigned int frame;
+	unsigned char source;
+	bool down; // keys and mouse buttons
+	short code; // the key or mouse button
+	float x; // cursor position or scroll offset
+	float y;
 };
 
-namespace std {
-	template<>
-	struct hash<ActionBinding> {
-		std::size_t operator()(const ActionBinding& a) const noexcept {
-			std::size_t h1 = std::hash<int>{}(a.key);
-			std::size_t h2 = std::hash<int>{}(static_cast<int>(a.type));
+// Events and delta times over a run of frames, frames counted from the start of the
+// recording. Played back, events reach the bindings and callbacks exactly as they did
+// when recorded.
+struct InputStream {
+	std::vector<short> heldKeys; // down when the recording started
+	std::vector<InputEvent> events;
+	std::vector<float> frameTimes; // seconds, the delta time of every frame
+	unsigned int frameCount = 0;
+};
 
-			return h1 ^ (h2 << 1);
-		}
-	};
-}
+// Compact binary files, a small header followed by the held keys, the frame times and
+// the events as they are in memory. Both print the error and return false on failure.
+// Loading rejects streams with keys or buttons out of range, frames out of order or past
+// the frame count, and counts that don't match the file's size.
+bool saveInputStream(const char* path, const InputStream& stream);
+bool loadInputStream(const char* path, InputStream& stream);
 
+// Keys arrive as GLFW events and are kept as two bitsets, this frame's and the last.
+// Bindings are compiled into flat arrays indexed by key, so Process only looks at the
+// keys that changed and the held keys with a PRESSED binding. Mouse events are queued
+// the same way and handed to the callbacks given to Init from Process, in order with
+// the keys, so they can be recorded and replayed along with them.
 class Input {
 public:
-	static void Process(GLFWwindow* window);
+	// Installs the key and mouse callbacks. Call before ImGui installs its own, ImGui
+	// chains them.
+	static void Init(GLFWwindow* window_, GLFWcursorposfun cursorHandler_, GLFWmousebuttonfun mouseButtonHandler_,
+		GLFWscrollfun scrollHandler_);
+
+	// Applies the events since the last call, in order, running the JUST_PRESSED and
+	// JUST_RELEASED bindings and the mouse callbacks, then the PRESSED bindings of every
+	// held key. `deltaTime` is what GetDeltaTime returned for the frame, it is recorded.
+	static void Process(float deltaTime);
+	// The delta time of the coming frame: `measured` live, the stream's during playback.
+	// Set it where the bindings read it before calling Process.
+	static float GetDeltaTime(float measured);
 	static void BindAction(int key, InputEventType type, std::function<void()> callback);
 
+	static bool Pressed(int key);
+	static bool JustPressed(int key);
+	static bool JustReleased(int key);
+	// Of the last cursor event applied, replayed ones included.
+	static void GetCursorPosition(double& x, double& y);
+
+	// Keeps every event Process applies, and every delta time, until StopRecording.
+	static void StartRecording();
+	static InputStream StopRecording();
+	static bool IsRecording();
+
+	// Replaces the keyboard and mouse with the stream, a frame of it per Process until it
+	// runs out, in lockstep with the recorded delta times or `fixedDeltaTime` when above 0.
+	// Keys start as they were when recording started, without running edge bindings, and
+	// end released.
+	static void StartPlayback(const InputStream& stream, float fixedDeltaTime = 0.0f);
+	static void StopPlayback();
+	static bool IsPlaying();
+	static unsigned int GetPlaybackFrame(); // frames played so far
+
 private:
-	static std::array<KeyState, GLFW_KEY_LAST + 1> keyStates;
-	static std::unordered_map<ActionBinding, std::function<void()>> actions;
+	static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+	static void cursorPosCallback(GLFWwindow* window, double xpos, double ypos);
+	static void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
+	static void scrollCallback(GLFWwindow* window, double xoffset, double yoffset);
+	static void dispatch(const InputEvent& event);
+	static void applyEvent(int key, bool down);
+	static void releaseAll();
+
+	static std::bitset<GLFW_KEY_LAST + 1> current;
+	static std::bitset<GLFW_KEY_LAST + 1> previous;
+	static std::vector<InputEvent> pending; // from the callbacks, since the last Process
+
+	static GLFWwindow* window;
+	static GLFWcursorposfun cursorHandler;
+	static GLFWmousebuttonfun mouseButtonHandler;
+	static GLFWscrollfun scrollHandler;
+	static double cursorX;
+	static double cursorY;
+
+	static std::array<std::array<short, GLFW_KEY_LAST + 1>, INPUT_EVENT_TYPE_COUNT> bindings; // into actions, -1 unbound
+	static std::vector<std::function<void()>> actions;
+	static std::vector<short> heldKeys; // down and bound to PRESSED
+
+	static bool recording;
+	static InputStream recorded;
+	static bool playing;
+	static InputStream playback;
+	static unsigned int playbackFrame;
+	static unsigned int playbackEvent; // next one to apply
+	static float playbackDeltaTime; // 0 for the recorded ones
 };
\ No newline at end of file
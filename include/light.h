@@ -69,6 +69,18 @@ private:
 };
 
 
+// std430 layout of one point light in the light buffer every lit shader reads at
+// POINT_LIGHT_BINDING, indexed like the lights' spheres passed to selectLights.
+struct PointLightData {
+    glm::vec4 position; // w: range, 0 when the light is off
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    glm::vec4 attenuation; // constant, linear, quadratic
+};
+
+const unsigned int POINT_LIGHT_BINDING = 5;
+
 class PointLight
 {
 public:
@@ -96,7 +108,15 @@ public:
         float linear_ = 0.0,
         float quadratic_ = 0.0);
 
-    void UpdateRadius(float radius);
+    // Attenuation that takes the brightest channel below `cutoff` exactly at `radius`,
+    // the inverse of GetRadius.
+    void UpdateRadius(float radius, float cutoff = 5.0f / 256.0f);
+    // Distance at which the brightest channel, attenuated, falls below `cutoff`.
+    // Infinite without attenuation.
+    float GetRadius(float cutoff = 5.0f / 256.0f) const;
+
+    // What the light buffer holds for this light, dark with a range of 0 when not shown.
+    PointLightData GetData() const;
 
     void Setup(Shader& shader, bool use = false, int id_ = -1);
 
@@ -105,4 +125,13 @@ public:
 
 private:
     bool isShowing;
-};
\ No newline at end of file
+
+    float brightness() const;
+};
+
+// Most point lights that shade one object, the lit shaders loop over no more.
+const int MAX_OBJECT_LIGHTS = 4;
+
+// Indices of the lights whose sphere (center, range) reaches `bounds`, the closest
+// relative to their range first, padded with -1. Lights past MAX_OBJECT_LIGHTS are dropped.
+glm::ivec4 selectLights(const std::vector<glm::vec4>& lightSpheres, const glm::vec4& bounds);
\ No newline at end of file
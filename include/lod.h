@@ -0,0 +1,63 @@
+#pragma once
+
+#include "mesh.h"
+#include "objects.h"
+
+#include <glm/glm.hpp>
+
+#include <unordered_map>
+#include <vector>
+
+struct LODLevel {
+    Mesh* mesh;
+    float minScreenSize; // projected diameter over screen height, below it the next level takes over
+    unsigned int instanceCount; // submitted this frame
+};
+
+// Picks a tessellation level per instance from its projected size, then draws
+// the instances bucketed by level so each mesh is bound once per frame.
+class LODGroup
+{
+public:
+    float bias; // scales projected sizes, above 1 keeps finer levels longer
+    float hysteresis; // fraction a size has to cross a threshold by before switching
+
+    LODGroup(float bias_ = 1.0f, float hysteresis_ = 0.15f);
+
+    // Finest first, the last level is used at any size.
+    void AddLevel(Mesh& mesh, float minScreenSize);
+
+    void Clear();
+    // Instances are assumed to use a mesh of unit radius, scaled by their largest scale axis.
+    void Submit(Object3D* object, const glm::vec3& cameraPosition, float fovY);
+    void Draw();
+    // Geometry only, for passes that bring their own shader and state.
+    void DrawGeometry(Shader& shader);
+    // Same selection as Submit, for callers that draw the mesh themselves. Only counted
+    // once they call Count, after the draw is actually issued.
+    Mesh& Select(Object3D* object, const glm::vec3& cameraPosition, float fovY);
+    void Count(Object3D* object);
+
+    unsigned int GetLevelCount() const;
+    const LODLevel& GetLevel(unsigned int level) const;
+    unsigned int GetTrianglesSubmitted() const;
+    unsigned int GetTrianglesFullDetail() const;
+
+private:
+    std::vector<LODLevel> levels;
+    std::vector<std::vector<Object3D*>> buckets;
+    // Levels picked this frame and the last, so entries of objects that stop being
+    // submitted, or were removed, drop out instead of passing to a reused address.
+    std::unordered_map<Object3D*, int> currentLevels;
+    std::unordered_map<Object3D*, int> previousLevels;
+
+    unsigned int trianglesSubmitted;
+    unsigned int trianglesFullDetail;
+
+    int selectLevel(float screenSize, int currentLevel) const;
+    int updateLevel(Object3D* object, const glm::vec3& cameraPosition, float fovY);
+    void count(int level);
+};
+
+// Diameter of a sphere on screen as a fraction of the screen height.
+float projectedSize(const glm::vec3& center, float radius, const glm::vec3& cameraPosition, float fovY);
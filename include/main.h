@@ -13,22 +13,25 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
-unsigned int loadTexture(const char* path);
+// srgb for color maps, their texels are decoded to linear when sampled.
+unsigned int loadTexture(const char* path, bool srgb = false);
 unsigned int loadCubemap(std::vector<std::string> faces);
 
-void cubeMeshSetup(unsigned int& VBO, unsigned int& VAO);
-void cubeMeshSetupX(unsigned int& VBO, unsigned int& VAO, glm::vec2 UV);
-unsigned int sphereMeshSetup(unsigned int& sphereVBO, unsigned int& sphereVAO, unsigned int& sphereEBO, int stacks = 20, int sectors = 20);
+// Every opaque draw of the frame with one shader, for passes that don't shade.
+void drawOpaqueGeometry(Shader& shader, Shader& indirectShader, const glm::mat4& view, const glm::mat4& projection);
 
-CollisionInfo checkCollision(const SphereShape& s1, const SphereShape& s2);
-CollisionInfo checkCollision(const SphereShape& s1, const AABBShape& s2);
-CollisionInfo checkCollision(const AABBShape& s1, const SphereShape& s2);
-CollisionInfo checkCollision(const AABBShape& s1, const AABBShape& s2);
-CollisionInfo checkCollisions(const Rigidbody& obj1, const Rigidbody& obj2);
+// Replaces every point light after the lamp with `count` random ones over the floor.
+void scatterLights(int count);
 
-void DrawWithOutline(Object3D obj, Shader& shader_, glm::vec3 color = glm::vec3(1.0f, 1.0f, 1.0f));
+// Times shading on every path at every benchmark light count, one step per call of
+// updateLightBenchmark, once a frame. The results are printed and shown in the UI.
+void startLightBenchmark();
+void updateLightBenchmark();
+
+// Prints the mean and percentiles of the frame times of a --replay run, and writes their
+// histogram to the --histogram file when there is one, to diff against other builds.
+void reportReplay();
 
-void resolveCollision(Rigidbody& A, Rigidbody& B, const CollisionInfo& info);
 void resolveSpecialCollision(Rigidbody& A, Rigidbody& B, const CollisionInfo& info);
 
 void APIENTRY glDebugOutput(GLenum source, GLenum type, unsigned int id, GLenum severity,
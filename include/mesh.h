@@ -0,0 +1,137 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <map>
+#include <tuple>
+#include <vector>
+
+// Matches the attribute layout every shader expects: position (0), normal (1), texCoord (2).
+struct Vertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+
+// GPU-side layouts, decoded by the attribute fetch so shaders always see
+// vec3 position, vec3 normal and vec2 texCoords.
+enum class VertexFormat {
+    FLOAT,     // 32 bytes, float position, normal and texCoords
+    PACKED,    // 20 bytes, float position, 2_10_10_10 normal, half texCoords
+    QUANTIZED  // 16 bytes, snorm16 position, 2_10_10_10 normal, half texCoords
+};
+
+const char* vertexFormatName(VertexFormat format);
+unsigned int vertexFormatSize(VertexFormat format);
+
+// Interleaved bytes in the GPU layout of `format`.
+std::vector<unsigned char> encodeVertices(const std::vector<Vertex>& vertices, VertexFormat format);
+// Attributes 0 to 2 for the bound VAO, reading from the bound GL_ARRAY_BUFFER.
+void setVertexAttributes(VertexFormat format);
+
+class GeometryArena;
+
+// Where a mesh lives inside a GeometryArena, its indices are relative to baseVertex.
+struct ArenaRange {
+    bool valid;
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    int baseVertex;
+};
+
+struct MeshStats {
+    unsigned int triangleCount;
+    unsigned int soupVertexCount; // vertices before deduplication, 3 per triangle
+    unsigned int vertexCount;
+
+    // average cache miss ratio, i.e. vertex shader invocations per triangle
+    float acmrGenerated; // index order as generated
+    float acmrOptimized; // after the Forsyth reorder
+
+    unsigned int vertexBytes;
+    unsigned int indexBytes;
+};
+
+// Generators append an unindexed triangle list, CCW seen from outside.
+void generateCube(glm::vec2 UV, std::vector<Vertex>& vertices);
+void generateSphere(int stacks, int sectors, std::vector<Vertex>& vertices);
+void generatePlane(int subdivisions, glm::vec2 UV, std::vector<Vertex>& vertices);
+
+// Merges bitwise identical vertices and builds the index buffer.
+void deduplicateVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+// Tom Forsyth's linear-speed vertex cache optimisation, reorders triangles in place.
+void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount);
+// Renumbers vertices by first use so fetches walk the vertex buffer in order.
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+// Misses of a FIFO post-transform cache per triangle, 3.0 is no reuse at all.
+float computeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize = 16);
+
+// Owns its GL objects, so it can be moved but never copied.
+// Indices are 16-bit whenever the vertex count allows it.
+class Mesh
+{
+public:
+    unsigned int VAO;
+    unsigned int VBO;
+    unsigned int EBO;
+    unsigned int indexCount;
+    unsigned int indexType; // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    VertexFormat format;
+    float radius; // bounding sphere around the local origin
+    MeshStats stats;
+    ArenaRange arenaRange; // invalid unless the cache that built it has an arena
+
+    Mesh();
+    // QUANTIZED positions cover [-1, 1], meshes outside that fall back to PACKED.
+    Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+        VertexFormat format_ = VertexFormat::FLOAT);
+    ~Mesh();
+
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+    Mesh(Mesh&& other) noexcept;
+    Mesh& operator=(Mesh&& other) noexcept;
+
+private:
+    void release();
+};
+
+// Procedural meshes keyed by their parameters, every request for the same
+// parameters shares one set of buffers. References stay valid until Clear().
+class MeshCache
+{
+public:
+    MeshCache(VertexFormat format_ = VertexFormat::QUANTIZED, GeometryArena* arena_ = nullptr);
+
+    Mesh& GetCube(glm::vec2 UV = glm::vec2(1.0f));
+    Mesh& GetSphere(int stacks = 20, int sectors = 20);
+    Mesh& GetPlane(int subdivisions = 1, glm::vec2 UV = glm::vec2(1.0f));
+
+    // Meshes built afterwards are also copied into the arena, which takes the cache's format.
+    void SetArena(GeometryArena* arena_);
+
+    // Rebuilds every cached mesh in place, so existing references see the new buffers.
+    void SetFormat(VertexFormat format_);
+    VertexFormat GetFormat() const;
+
+    // Needs a current GL context, call it before the window is destroyed.
+    void Clear();
+
+    unsigned int GetMeshCount() const;
+    unsigned int GetVertexBytes() const;
+    unsigned int GetIndexBytes() const;
+
+private:
+    enum class MeshKind { CUBE, SPHERE, PLANE };
+    using Key = std::tuple<MeshKind, int, int, float, float>;
+
+    std::map<Key, Mesh> meshes;
+    VertexFormat format;
+    GeometryArena* arena;
+
+    void generate(const Key& key, std::vector<Vertex>& vertices) const;
+    Mesh build(const Key& key) const;
+};
@@ -9,12 +9,30 @@
 
 #include <variant>
 
+class Mesh;
+class StreamBuffer;
+
+// Per-object uniform block of the lit shaders, std140.
+struct ObjectData {
+    glm::mat4 model;
+    glm::vec4 scaleUV; // xy, zw unused
+    glm::vec4 color;
+    glm::ivec4 lights; // point light indices, -1 past the last
+};
+
+const unsigned int OBJECT_DATA_BINDING = 1;
+
 enum class ObjectType {
     DYNAMIC,
     KINEMATIC,
     STATIC
 };
 
+enum class ShapeType {
+    SPHERE,
+    AABB
+};
+
 struct CollisionInfo {
     bool collided;
     glm::vec3 normal;
@@ -58,6 +76,16 @@ public:
 
     Shader& shader;
     bool drawElements;
+    unsigned int indexType;
+    Mesh* mesh; // set by the Mesh constructors, nullptr for raw VAOs
+    glm::ivec4 lights; // point lights that reach the object, none until set, see selectLights
+
+    // Shaders with the ObjectData block get their per-object data from here,
+    // every other shader still gets uniforms.
+    static StreamBuffer* streamBuffer;
+    // Holds the block instead for draws the stream buffer's frame region has no room
+    // for, until it grows on the next frame. Created on first use.
+    static unsigned int objectDataBuffer;
 
     Object3D(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
         unsigned int& VAO_,
@@ -67,11 +95,23 @@ public:
         unsigned int texture1_ = 0, unsigned int texture2_ = 0, unsigned int texture3_ = 0, 
         glm::vec2 UVScale_ = glm::vec2(1.0f), glm::vec3 color_ = glm::vec3(1.0f));
 
+    Object3D(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
+        Mesh& mesh_,
+        Shader& shader_,
+        unsigned int texture1_ = 0, unsigned int texture2_ = 0, unsigned int texture3_ = 0,
+        glm::vec2 UVScale_ = glm::vec2(1.0f), glm::vec3 color_ = glm::vec3(1.0f));
+
     Object3D& operator=(const Object3D& other);
 
     glm::mat4 GetModelMatrix();
+    // World-space bounding sphere, center and radius, tested by every culling pass.
+    glm::vec4 GetBounds();
 
     void Draw(unsigned int type = GL_TEXTURE_2D);
+    // Shader, uniforms and textures without the draw, for callers that bring their own geometry.
+    void Bind(unsigned int type = GL_TEXTURE_2D);
+    // Geometry only, for passes that bring their own shader and state.
+    void DrawGeometry(Shader& shader_);
 
     void SetPosition(glm::vec3 position_);
     void SetPosition(float x, float y, float z);
@@ -94,6 +134,10 @@ public:
     std::variant<SphereShape, AABBShape> shape;
     ObjectType behavior;
     bool canCollide;
+    float restitution;
+    bool ccd; // swept this step, set by PhysicsWorld
+    bool sleeping;
+    float sleepTimer;
 
     Rigidbody(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
         unsigned int& VAO_,
@@ -102,7 +146,16 @@ public:
         bool drawElements_,
         float mass_,
         ObjectType type_ = ObjectType::DYNAMIC,
-        //ShapeType shape_ = SphereShape(glm::vec3(0.0f), -1.0f),
+        ShapeType shapeType_ = ShapeType::AABB,
+        unsigned int texture1_ = 0, unsigned int texture2_ = 0, unsigned int texture3_ = 0,
+        glm::vec2 UVScale = glm::vec2(1.0f), glm::vec3 color = glm::vec3(0.0f));
+
+    Rigidbody(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
+        Mesh& mesh_,
+        Shader& shader_,
+        float mass_,
+        ObjectType type_ = ObjectType::DYNAMIC,
+        ShapeType shapeType_ = ShapeType::AABB,
         unsigned int texture1_ = 0, unsigned int texture2_ = 0, unsigned int texture3_ = 0,
         glm::vec2 UVScale = glm::vec2(1.0f), glm::vec3 color = glm::vec3(0.0f));
 
@@ -110,6 +163,11 @@ public:
 
     void ApplyForce(const glm::vec3& force);
     void PhysicsProcess(float deltaTime);
+    void IntegrateVelocity(float deltaTime);
+    void IntegratePosition();
+
+    void Sleep();
+    void Wake();
 
     void SetPosition(glm::vec3 position_);
     void SetPosition(float x, float y, float z);
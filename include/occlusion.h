@@ -0,0 +1,52 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Screen rectangle and nearest depth of a world-space sphere, in [0, 1] like the
+// depth buffer. Fails when the sphere crosses the camera plane, such a sphere is
+// never considered occluded.
+bool projectSphereBounds(const glm::vec3& center, float radius, const glm::mat4& viewProjection,
+    glm::vec2& rectMin, glm::vec2& rectMax, float& nearestDepth);
+
+// Mip level at which a rectangle of `size` texels at level 0 covers at most 2x2 texels.
+int hiZLevel(const glm::vec2& size, int levelCount);
+
+// CPU counterpart of HiZBuffer, with no GL dependency: occluder triangles are
+// rasterized into a small depth buffer, reduced into the same farthest-depth
+// pyramid and queried with the same test the culling shader uses.
+class SoftwareOcclusion
+{
+public:
+    SoftwareOcclusion(int width_ = 256, int height_ = 128);
+
+    void Resize(int width_, int height_);
+
+    // Clears to the far plane.
+    void Begin(const glm::mat4& viewProjection_);
+    // Triangles are clipped against the near plane, the far side needs no clipping.
+    void AddTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c);
+    void AddBox(const glm::vec3& min, const glm::vec3& max);
+    void End();
+
+    bool IsOccluded(const glm::vec3& center, float radius) const;
+
+    int GetWidth() const;
+    int GetHeight() const;
+    int GetLevelCount() const;
+    float GetDepth(int level, int x, int y) const;
+    unsigned int GetTriangleCount() const;
+
+private:
+    int width;
+    int height;
+    glm::mat4 viewProjection;
+    unsigned int triangleCount;
+
+    // level 0 is the rasterized depth, every level after it half the size
+    std::vector<std::vector<float>> levels;
+    std::vector<glm::ivec2> levelSizes;
+
+    void rasterize(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+};
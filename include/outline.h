@@ -0,0 +1,51 @@
+#pragma once
+
+#include "objects.h"
+#include "rendertargets.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+// Selected objects are drawn once into an R8 mask with no depth test, then a single
+// fullscreen pass colors every pixel outside the mask that has a masked pixel within
+// `width`. The cost depends on screen area, not on how many objects are selected. The
+// mask is the caller's, a transient target from a RenderGraph.
+class OutlinePass
+{
+public:
+    static const GLenum MASK_FORMAT = GL_R8;
+
+    glm::vec3 color;
+    int width; // in pixels
+
+    OutlinePass(glm::vec3 color_ = glm::vec3(1.0f), int width_ = 3);
+
+    OutlinePass(const OutlinePass&) = delete;
+    OutlinePass& operator=(const OutlinePass&) = delete;
+
+    // Both need a current GL context, so neither can live in the constructor
+    // or destructor of a global.
+    void Init();
+    void Release();
+
+    void Clear();
+    void Add(Object3D* object);
+
+    // Outlines the selection into the currently bound framebuffer, through `mask`, a
+    // MASK_FORMAT target the size of the screen.
+    void Draw(const RenderTarget& mask, const glm::mat4& view, const glm::mat4& projection);
+
+    unsigned int GetSelectedCount() const;
+
+private:
+    std::vector<Object3D*> selected;
+
+    Shader maskShader;
+    Shader edgeShader;
+
+    unsigned int emptyVAO; // the fullscreen triangle is generated from gl_VertexID
+};
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "rendertargets.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+// Counts the fragments the lit pass shades with a GL_SAMPLES_PASSED query, and can
+// show where they go: with the view on, the opaque passes are redirected into an
+// R16F target where every fragment adds 1, and a fullscreen pass maps the count per
+// pixel to a heat ramp on top of the scene. The counting target is the caller's, a
+// transient one from a RenderGraph.
+class OverdrawPass
+{
+public:
+    static const GLenum COUNT_FORMAT = GL_R16F; // blends everywhere and counts exactly up to 2048
+
+    float maxCount; // fragments per pixel shown at the hot end of the ramp
+
+    OverdrawPass(float maxCount_ = 8.0f);
+
+    OverdrawPass(const OverdrawPass&) = delete;
+    OverdrawPass& operator=(const OverdrawPass&) = delete;
+
+    // Both need a current GL context.
+    void Init();
+    void Release();
+
+    // Wrap the shading pass, over its viewport. The result is read a frame late, without
+    // stalling.
+    void BeginQuery();
+    void EndQuery();
+
+    // Binds `counts`, a COUNT_FORMAT target with depth, with additive blending. The
+    // caller draws the opaque geometry with GetCountShader or GetCountIndirectShader,
+    // and End draws the heatmap into the previous framebuffer.
+    void Begin(const RenderTarget& counts);
+    void End();
+
+    Shader& GetCountShader();
+    Shader& GetCountIndirectShader();
+
+    unsigned long long GetFragmentCount() const;
+    unsigned long long GetPixelCount() const; // of the last shading pass
+
+private:
+    Shader countShader;
+    Shader countIndirectShader;
+    Shader heatmapShader;
+
+    unsigned int countTexture; // the target of the last Begin
+    unsigned int emptyVAO;
+    int width; // viewport of the last shading pass
+    int height;
+
+    // ping-ponged so the one being read was issued a frame ago
+    unsigned int queries[2];
+    int currentQuery;
+    bool queryPending[2];
+    unsigned long long fragmentCount;
+
+    int targetFBO;
+    int targetViewport[4];
+};
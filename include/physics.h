@@ -0,0 +1,180 @@
+#pragma once
+
+#include "bvh.h"
+#include "objects.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+struct SweepInfo {
+    bool hit;
+    float toi; // fraction of the displacement travelled before contact, [0, 1]
+    glm::vec3 normal;
+
+    SweepInfo(bool hit_ = false, float toi_ = 1.0f, glm::vec3 normal_ = glm::vec3(0.0f, 0.0f, 0.0f));
+};
+
+CollisionInfo checkCollision(const SphereShape& s1, const SphereShape& s2);
+CollisionInfo checkCollision(const SphereShape& s1, const AABBShape& s2);
+CollisionInfo checkCollision(const AABBShape& s1, const SphereShape& s2);
+CollisionInfo checkCollision(const AABBShape& s1, const AABBShape& s2);
+CollisionInfo checkCollisions(const Rigidbody& obj1, const Rigidbody& obj2);
+
+bool raycastAABB(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& boxMin, const glm::vec3& boxMax,
+    float maxT, float& tHit, glm::vec3& normal);
+bool raycastSphere(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& center, float radius,
+    float maxT, float& tHit, glm::vec3& normal);
+bool raycastBody(const Rigidbody& body, const glm::vec3& origin, const glm::vec3& direction,
+    float maxT, float& tHit, glm::vec3& normal);
+
+// Time of impact of a sphere moving by `displacement` against another shape.
+// Shapes that already overlap at t = 0 report no hit, the discrete test handles them.
+SweepInfo sweepSphere(const SphereShape& s, const glm::vec3& displacement, const SphereShape& other,
+    const glm::vec3& otherDisplacement = glm::vec3(0.0f));
+SweepInfo sweepSphere(const SphereShape& s, const glm::vec3& displacement, const AABBShape& other);
+SweepInfo sweepSphere(const SphereShape& s, const glm::vec3& displacement, const Rigidbody& other);
+
+void computeBounds(const Rigidbody& body, glm::vec3& boundsMin, glm::vec3& boundsMax);
+
+float inverseMass(const Rigidbody& body);
+void resolveCollision(Rigidbody& A, Rigidbody& B, const CollisionInfo& info);
+
+struct BroadphaseProxy {
+    glm::vec3 min;
+    glm::vec3 max;
+    int body;
+};
+
+// Shapes never rotate, so every manifold is a single point along the normal.
+struct ContactConstraint {
+    int bodyA;
+    int bodyB;
+    glm::vec3 normal; // from B to A
+    float penetration;
+
+    float invMassA;
+    float invMassB;
+    float normalMass;
+    float velocityBias; // restitution target for the normal velocity
+    float normalImpulse; // accumulated over the iterations, persisted between steps
+};
+
+struct CachedContact {
+    glm::vec3 normal;
+    float normalImpulse;
+};
+
+struct RaycastHit {
+    Rigidbody* body;
+    float distance;
+    glm::vec3 point;
+    glm::vec3 normal;
+};
+
+class PhysicsWorld
+{
+public:
+    glm::vec3 gravity; // applied through ApplyForce, like any other force
+    float ccdThreshold; // displacement per step, in radii, above which a sphere is swept
+    int maxSubsteps;
+
+    int velocityIterations;
+    bool warmStarting;
+    float restitutionVelocity; // closing speed under which contacts don't bounce
+    float correctionPercent;
+    float correctionSlop;
+
+    bool allowSleeping;
+    float sleepVelocity; // per-step displacement below which a body counts as resting
+    float timeToSleep; // seconds a whole island has to rest before it is put to sleep
+
+    std::function<void(Rigidbody&, Rigidbody&, const CollisionInfo&)> onCollision;
+
+    PhysicsWorld(glm::vec3 gravity_ = glm::vec3(0.0f, -0.0098f, 0.0f), float ccdThreshold_ = 0.5f, int maxSubsteps_ = 4);
+
+    void Add(Rigidbody* body);
+    void Remove(Rigidbody* body);
+
+    void Step(float deltaTime);
+
+    void WakeIsland(Rigidbody* body);
+
+    // Scene queries, against the state of the last step
+    bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RaycastHit& hit);
+    void OverlapSphere(const glm::vec3& center, float radius, std::vector<Rigidbody*>& results);
+    void OverlapAABB(const glm::vec3& min, const glm::vec3& max, std::vector<Rigidbody*>& results);
+
+    const std::vector<Rigidbody*>& GetBodies() const;
+    unsigned int GetCCDCount() const;
+    unsigned int GetSleepingCount() const;
+    unsigned int GetPairCount() const;
+    unsigned int GetContactCount() const;
+    unsigned int GetWarmStartedCount() const;
+    const BVH& GetStaticTree() const;
+    const BVH& GetDynamicTree() const;
+
+private:
+    std::vector<Rigidbody*> bodies;
+    unsigned int ccdCount;
+    unsigned int sleepingCount;
+
+    // sort-and-sweep on x over dynamic bodies, sleeping ones keep their cached bounds
+    std::vector<BroadphaseProxy> proxies;
+    std::vector<std::pair<int, int>> pairs;
+    bool proxiesDirty;
+
+    // static and kinematic bodies, refit per kinematic body as it moves
+    BVH staticTree;
+    std::vector<int> staticBodies; // tree item -> body
+    std::vector<int> kinematicItems;
+    std::vector<glm::vec3> staticMin;
+    std::vector<glm::vec3> staticMax;
+    std::vector<char> kinematicMoved;
+    std::vector<int> queryResults;
+
+    // dynamic bodies for scene queries only, refit lazily when a query needs it
+    BVH dynamicTree;
+    std::vector<int> dynamicBodies; // tree item -> body
+    std::vector<char> dynamicMoved; // per body, set by the steps since the last refit
+    unsigned int dynamicMovedCount;
+    bool dynamicTreeDirty;
+    float dynamicTreeBuildArea;
+
+    // solver
+    std::vector<ContactConstraint> contacts;
+    std::unordered_map<uint64_t, CachedContact> contactCache;
+    unsigned int warmStartedCount;
+
+    // union-find over contacts between awake dynamic bodies
+    std::vector<int> islandParent;
+    std::vector<float> islandTimer;
+    std::vector<int> islandSleepId;
+    std::vector<int> sleepIsland; // island a sleeping body was put to sleep with, -1 when awake
+    int nextSleepIsland;
+
+    void rebuildBroadphase();
+    void updateBroadphase();
+    void findPairs();
+    void updateDynamicTree();
+    void addContact(int i, int j, const CollisionInfo& info);
+
+    void prepareContacts();
+    void solveVelocities();
+    void correctPositions();
+    void storeImpulses();
+
+    int findIsland(int i);
+    void unionIslands(int a, int b);
+    void updateSleeping(float deltaTime);
+    void wakeIsland(int i);
+
+    bool isActive(int i) const;
+    bool isMoving(int i) const;
+
+    bool needsCCD(const Rigidbody& body, const glm::vec3& displacement) const;
+    void integrateSwept(Rigidbody& body);
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "rendertargets.h"
+
+#include <glad/glad.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// A frame described as passes that declare the resources they read and write, rebuilt
+// every frame and compiled before it runs:
+//  - passes run in the order they were added, a pass can only depend on earlier ones
+//  - passes that lead to no output are culled, walking back from the outputs
+//  - transient targets are acquired right before their first pass and freed after their
+//    last, so targets of the same size and format share memory when their passes don't
+//    overlap
+//  - glMemoryBarrier goes in front of every pass that accesses what an earlier pass
+//    wrote through an image or storage buffer, with the bits that access needs
+// Writes keep what they land on, a pass that blends into or depth tests against a target
+// keeps its earlier writers alive. Passes bind their own targets.
+class RenderGraph
+{
+public:
+    // How a pass touches a resource, decides the barrier in front of it.
+    enum Access {
+        ACCESS_ATTACHMENT, // rendered to or depth tested against
+        ACCESS_SAMPLED,
+        ACCESS_IMAGE, // image loads and stores
+        ACCESS_STORAGE, // shader storage buffer
+        ACCESS_INDIRECT, // draw or dispatch arguments
+        ACCESS_UNIFORM,
+        ACCESS_TRANSFER // blits, copies and uploads
+    };
+
+    RenderGraph();
+
+    RenderGraph(const RenderGraph&) = delete;
+    RenderGraph& operator=(const RenderGraph&) = delete;
+
+    // Needs a current GL context, deletes the transient targets.
+    void Release();
+
+    // A resource owned elsewhere that outlives the frame. Imported once, the handle stays
+    // valid across Reset, and so does a pending barrier: a read next frame still waits.
+    int Import(const char* name);
+    // Imported resources the frame exists to produce, the window or a pyramid read next
+    // frame. Passes that lead to none of them are culled.
+    void SetOutput(int resource, bool output = true);
+
+    // Starts the next frame, dropping its passes and transient targets.
+    void Reset();
+    int CreateTarget(const char* name, int width, int height, GLenum format, bool depth = false);
+
+    int AddPass(const char* name, std::function<void()> execute);
+    void Read(int pass, int resource, Access access);
+    void Write(int pass, int resource, Access access);
+
+    // Culls, plans the barriers and the target lifetimes. Execute runs what survived.
+    void Compile();
+    void Execute();
+
+    // Valid while the passes that use it run.
+    const RenderTarget& GetTarget(int resource) const;
+
+    RenderTargetPool& GetPool();
+    unsigned int GetPassCount() const;
+    const char* GetPassName(int pass) const;
+    bool IsCulled(int pass) const;
+    GLbitfield GetBarriers(int pass) const;
+    unsigned int GetCulledCount() const;
+    unsigned int GetBarrierCount() const; // glMemoryBarrier calls of the last Compile
+
+private:
+    struct Resource {
+        std::string name;
+        bool imported;
+        bool output;
+
+        // transient targets only
+        int width;
+        int height;
+        GLenum format;
+        bool depth;
+        RenderTarget target;
+        int firstPass; // -1 when no surviving pass uses it
+        int lastPass;
+
+        // the last write went through an image or storage buffer and these barrier
+        // bits haven't been issued since
+        bool incoherent;
+        GLbitfield issued;
+    };
+
+    struct Use {
+        int resource;
+        Access access;
+        bool write;
+    };
+
+    struct Pass {
+        std::string name;
+        std::function<void()> execute;
+        std::vector<Use> uses;
+        bool culled;
+        GLbitfield barriers;
+    };
+
+    RenderTargetPool pool;
+    std::vector<Resource> resources;
+    unsigned int importedCount; // imported resources come first and survive Reset
+    std::vector<Pass> passes;
+    unsigned int culledCount;
+    unsigned int barrierCount;
+
+    void cull();
+    void planBarriers();
+    void planLifetimes();
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <vector>
+
+// A framebuffer with one color texture and, optionally, a depth-stencil texture.
+struct RenderTarget {
+    unsigned int FBO;
+    unsigned int texture;
+    unsigned int depthTexture; // 0 without depth
+    int width;
+    int height;
+    GLenum format;
+};
+
+// Transient render targets, handed out by size and format and taken back when a pass is
+// done with them, so later passes of the same frame can reuse their memory. Targets are
+// only deleted once they sat unused for a few frames: a resize costs one allocation per
+// target at the new size, and a steady frame none at all.
+class RenderTargetPool
+{
+public:
+    static const int KEEP_FRAMES = 2; // unused this long and a target is deleted
+
+    RenderTargetPool();
+
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    // Needs a current GL context, like everything that acquires.
+    void Release();
+
+    // A free target of exactly this size and format, allocated if there is none. Color
+    // is sampled with linear filtering and clamped at the edges.
+    RenderTarget Acquire(int width, int height, GLenum format, bool depth = false);
+    void Free(const RenderTarget& target);
+
+    // Deletes what went unused, call once every frame after the last Free.
+    void EndFrame();
+
+    unsigned int GetTargetCount() const;
+    unsigned int GetAllocationCount() const; // since the pool was created
+
+private:
+    struct Entry {
+        RenderTarget target;
+        bool inUse;
+        unsigned int lastUsedFrame;
+    };
+
+    std::vector<Entry> entries;
+    unsigned int frame;
+    unsigned int allocationCount;
+
+    RenderTarget allocate(int width, int height, GLenum format, bool depth);
+};
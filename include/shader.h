@@ -12,15 +12,20 @@ class Shader
 {
 public:
     unsigned int ID;
+    bool usesObjectData = false; // declares the ObjectData uniform block, see Object3D::Bind
 
     Shader() = default;
 
-    Shader(const char* vertexPath, const char* fragmentPath);
+    Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr);
+    // compute-only program
+    explicit Shader(const char* computePath);
 
     void use();
 
     void setMat4(const std::string& name, glm::mat4 value) const;
 
+    void setVec4(const std::string& name, glm::vec4 value) const;
+
     void setVec3(const std::string& name, glm::vec3 value) const;
     void setVec3(const std::string& name, float x, float y, float z) const;
 
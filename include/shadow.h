@@ -0,0 +1,171 @@
+#pragma once
+
+#include "light.h"
+#include "objects.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+
+class StreamBuffer;
+
+// Cascaded shadow map for a DirectionLight. The camera frustum is split into up to
+// four slices, each covered by an orthographic cascade in one layer of a depth array.
+// Cascades are fit to a bounding sphere of their slice, so their size never changes as
+// the camera turns, and their origin is snapped to whole texels so the map doesn't
+// shimmer as it moves. Casters are culled per cascade by their bounding spheres and
+// drawn instanced, one draw per shared VAO.
+class CascadedShadowMap
+{
+public:
+    static const int MAX_CASCADES = 4;
+
+    bool enabled;
+    int cascadeCount; // 2 to MAX_CASCADES
+    int resolution; // texels per side of every cascade
+    float shadowDistance; // view-space distance the last cascade ends at
+    float splitLambda; // 0 splits the distance evenly, 1 logarithmically
+
+    CascadedShadowMap(int cascadeCount_ = 3, int resolution_ = 2048);
+
+    CascadedShadowMap(const CascadedShadowMap&) = delete;
+    CascadedShadowMap& operator=(const CascadedShadowMap&) = delete;
+
+    // Both need a current GL context.
+    void Init();
+    void Release();
+
+    // Caster transforms are written here when set, into a buffer of our own otherwise.
+    void SetStreamBuffer(StreamBuffer* streamBuffer_);
+
+    // Fits the cascades to the camera frustum and renders the casters into them.
+    // Changes to cascadeCount and resolution take effect here.
+    void Render(const DirectionLight& light, const glm::mat4& view, float fovy, float aspect, float zNear, float zFar,
+        const std::vector<Object3D*>& casters);
+
+    // Binds the map to texture unit `unit` and sets the cascade uniforms of the lit
+    // shaders, the shader must be in use.
+    void Apply(Shader& shader, int unit) const;
+
+    int GetCascadeCount() const;
+    float GetSplit(int cascade) const;
+    unsigned int GetCasterCount(int cascade) const;
+    unsigned int GetDrawCount() const;
+
+private:
+    // Casters that share all of their geometry go out in one instanced draw.
+    struct CasterGroup {
+        unsigned int VAO;
+        unsigned int indexCount;
+        unsigned int indexType;
+        bool drawElements;
+        std::vector<glm::mat4> models;
+    };
+
+    Shader depthShader;
+    unsigned int FBO;
+    unsigned int depthTexture;
+    unsigned int modelBuffer;
+    StreamBuffer* streamBuffer;
+
+    int allocatedCount;
+    int allocatedResolution;
+
+    glm::mat4 matrices[MAX_CASCADES];
+    float splits[MAX_CASCADES]; // far end of every cascade, view-space distance
+    float texelSizes[MAX_CASCADES]; // world units per texel
+    unsigned int casterCounts[MAX_CASCADES];
+    unsigned int drawCount;
+
+    std::vector<CasterGroup> groups;
+    unsigned int groupCount; // groups past this are empty and kept for their allocations
+    std::vector<glm::mat4> models;
+
+    void allocate();
+    void renderCascade(int cascade, const glm::mat4& lightView, const glm::vec3& center, float radius,
+        const std::vector<Object3D*>& casters);
+    void addCaster(Object3D& object);
+};
+
+// Omnidirectional shadow map for a PointLight, rendered in a single layered pass: a
+// geometry shader sends every triangle to the cube faces its caster touches. Casters
+// are culled to the light's range, derived from its attenuation, and per face. The cube
+// is only re-rendered when the light or a caster in range moved since the last render.
+class PointShadowMap
+{
+public:
+    bool enabled;
+    int resolution; // texels per side of every face
+    float nearPlane;
+    float maxRange; // far plane when the light's own range is longer, or infinite
+
+    PointShadowMap(int resolution_ = 1024);
+
+    PointShadowMap(const PointShadowMap&) = delete;
+    PointShadowMap& operator=(const PointShadowMap&) = delete;
+
+    // Both need a current GL context.
+    void Init();
+    void Release();
+
+    // Caster data is written here when set, into a buffer of our own otherwise.
+    void SetStreamBuffer(StreamBuffer* streamBuffer_);
+
+    void Render(const PointLight& light, const std::vector<Object3D*>& casters);
+
+    // Binds the cube to texture unit `unit` and tells the lit shaders which light it
+    // belongs to, the shader must be in use.
+    void Apply(Shader& shader, int unit, int lightIndex) const;
+
+    float GetFarPlane() const;
+    unsigned int GetCasterCount() const; // in range at the last render
+    unsigned int GetDrawCount() const; // this frame, 0 when the cube was reused
+    unsigned int GetRenderCount() const; // since Init
+    unsigned int GetReuseCount() const;
+
+private:
+    // std430 layout, one per instance
+    struct ShadowCaster {
+        glm::mat4 model;
+        GLuint faceMask; // bit per cube face the caster touches
+        GLuint padding[3];
+    };
+
+    struct CasterGroup {
+        unsigned int VAO;
+        unsigned int indexCount;
+        unsigned int indexType;
+        bool drawElements;
+        std::vector<ShadowCaster> casters;
+    };
+
+    Shader depthShader;
+    unsigned int FBO;
+    unsigned int cubeTexture;
+    unsigned int casterBuffer;
+    StreamBuffer* streamBuffer;
+
+    int allocatedResolution;
+    float farPlane;
+    unsigned int drawCount;
+    unsigned int renderCount;
+    unsigned int reuseCount;
+
+    std::vector<CasterGroup> groups;
+    unsigned int groupCount; // groups past this are empty and kept for their allocations
+
+    // what the cube holds, compared against every frame to skip the render
+    bool valid;
+    glm::vec3 renderedPosition;
+    float renderedFarPlane;
+    std::vector<Object3D*> objects;
+    std::vector<Object3D*> renderedObjects;
+    std::vector<ShadowCaster> casters;
+    std::vector<ShadowCaster> renderedCasters;
+
+    void allocate();
+    void addCaster(Object3D& object, GLuint faceMask);
+    bool unchanged(const glm::vec3& position) const;
+};
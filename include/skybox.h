@@ -0,0 +1,46 @@
+#pragma once
+
+#include "gputimer.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+// The sky as one fullscreen triangle at the far plane, drawn after the opaque passes with
+// a LEQUAL test against their depth. Early-Z drops every covered pixel before the cube map
+// is sampled, where drawing it first shaded the whole screen. Depth clamp keeps the
+// triangle from being clipped when z = w rounds past the far plane. The fragments it still
+// shades are counted with a GL_SAMPLES_PASSED query, read back a frame late.
+class Skybox
+{
+public:
+    Skybox();
+
+    Skybox(const Skybox&) = delete;
+    Skybox& operator=(const Skybox&) = delete;
+
+    // Both need a current GL context.
+    void Init(unsigned int cubemap_);
+    void Release();
+
+    // Draws wherever the bound framebuffer's depth is still cleared.
+    void Draw(const glm::mat4& view, const glm::mat4& projection);
+
+    unsigned long long GetFragmentCount() const;
+    unsigned long long GetPixelCount() const; // of the viewport, what drawing the sky first shaded
+    float GetTime() const; // milliseconds on the GPU
+
+private:
+    Shader shader;
+    unsigned int cubemap;
+    unsigned int emptyVAO;
+    GpuTimer timer;
+
+    // ping-ponged so the one being read was issued a frame ago
+    unsigned int queries[2];
+    int currentQuery;
+    bool queryPending[2];
+    unsigned long long fragmentCount;
+    unsigned long long pixelCount;
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// Second order spherical harmonics, nine RGB coefficients: enough for the low frequencies
+// diffuse light is made of, evaluated with a few multiply-adds where a convolved cube map
+// would need a texture fetch.
+struct SphericalHarmonics {
+    static const int COEFFICIENT_COUNT = 9;
+
+    glm::vec3 coefficients[COEFFICIENT_COUNT];
+};
+
+// Projects a cube map's faces, in loadCubemap's order, and convolves the result with the
+// clamped cosine lobe divided by pi: evaluated at a normal it is the diffuse light an
+// albedo of 1 reflects. The faces are decoded to linear by stb_image, then split into
+// bands of rows shared by every hardware thread, which accumulate with SSE. Fails when a
+// face doesn't load or the faces differ in size.
+bool projectCubemap(const std::vector<std::string>& faces, SphericalHarmonics& result);
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glad/glad.h>
+
+// Ring allocator for data written once per frame and read by the GPU in the same
+// frame. The buffer is split into one region per frame in flight, each fenced when
+// its frame ends and waited on before it is reused, so writes never race the GPU.
+// With GL 4.4 the buffer is mapped once, persistent and coherent, and writes are a
+// memcpy. Older contexts fall back to glBufferSubData into the same fenced regions.
+// A frame that doesn't fit its region grows the buffer before the next one starts.
+class StreamBuffer
+{
+public:
+    static const int FRAME_COUNT = 3;
+
+    StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Both need a current GL context.
+    void Init(unsigned int regionSize_);
+    void Release();
+
+    // Waits for the GPU to be done with this frame's region, if it isn't already. After a
+    // frame that ran out of room, reallocates every region at twice the size until it fits.
+    void BeginFrame();
+    void EndFrame();
+
+    // Copies `size` bytes into this frame's region and returns their offset in
+    // the buffer, or -1 once the region is full.
+    GLintptr Write(const void* data, unsigned int size, unsigned int alignment = 16);
+
+    // Write followed by glBindBufferRange at the target's offset alignment,
+    // returns the offset like Write does.
+    GLintptr BindUniform(unsigned int binding, const void* data, unsigned int size);
+    GLintptr BindStorage(unsigned int binding, const void* data, unsigned int size);
+
+    unsigned int GetBuffer() const;
+    bool IsPersistent() const;
+    unsigned int GetRegionSize() const;
+    unsigned int GetBytesLastFrame() const;
+    float GetWaitTime() const; // milliseconds spent on the fence in the last BeginFrame
+
+private:
+    unsigned int buffer;
+    unsigned char* mapped; // whole buffer, null on the fallback path
+    bool persistent;
+
+    unsigned int regionSize;
+    unsigned int uniformAlignment;
+    unsigned int storageAlignment;
+
+    GLsync fences[FRAME_COUNT];
+    int region;
+    unsigned int head; // bytes used in the current region
+    unsigned int overflowBytes; // asked for past the end of the current region
+
+    unsigned int bytesLastFrame;
+    unsigned int bytesRequestedLastFrame; // including what didn't fit
+    float waitTime;
+    bool overflowReported;
+
+    void allocate();
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "rendertargets.h"
+#include "shader.h"
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+
+// Forward+ light culling. After the depth pre-pass a compute shader splits the screen
+// into TILE_SIZE pixel tiles, bounds the depth of every tile, culls the point lights'
+// spheres and the spot lights' cones against the tile's frustum and writes the lights
+// that are left as a list per tile. The lit shaders, with tiledLights set, then shade
+// the lights of their pixel's tile instead of the four their object was given.
+class TiledLightCuller
+{
+public:
+    static const int TILE_SIZE = 16;
+    static const int MAX_TILE_LIGHTS = 128; // more in one tile are dropped
+    static const unsigned int TILE_BINDING = 6;
+
+    float maxCount; // lights per tile shown at the hot end of the heatmap
+
+    TiledLightCuller(float maxCount_ = 32.0f);
+
+    TiledLightCuller(const TiledLightCuller&) = delete;
+    TiledLightCuller& operator=(const TiledLightCuller&) = delete;
+
+    // Both need a current GL context.
+    void Init(int screenWidth, int screenHeight);
+    void Release();
+
+    void Resize(int screenWidth, int screenHeight);
+
+    // Culls the lights in the light buffer at POINT_LIGHT_BINDING against the depth of
+    // `scene`, which must hold the pre-pass and is sampled as it is. The tile lists
+    // are bound at TILE_BINDING for the shading pass that follows, which reads them as
+    // storage after a GL_SHADER_STORAGE_BARRIER_BIT.
+    void Cull(const RenderTarget& scene, const glm::mat4& view, const glm::mat4& projection, unsigned int pointLightCount);
+
+    // Sets the lit shaders' tile uniforms, the shader must be in use.
+    void Apply(Shader& shader) const;
+
+    // Lights per tile as a heat ramp over the bound framebuffer.
+    void DrawHeatmap();
+
+    Shader& GetCullShader(); // takes the spot light uniforms like the lit shaders
+
+    int GetTileCountX() const;
+    int GetTileCountY() const;
+
+private:
+    Shader cullShader;
+    Shader heatmapShader;
+
+    unsigned int tileBuffer;
+    unsigned int emptyVAO;
+    int width;
+    int height;
+    int tileCountX;
+    int tileCountY;
+};
@@ -0,0 +1,488 @@
+#include "arena.h"
+
+#include "camera.h"
+#include "hiz.h"
+#include "streambuffer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+
+#pragma region GeometryArena Methods
+GeometryArena::GeometryArena() :
+    format(VertexFormat::FLOAT), VAO(0), VBO(0), EBO(0), drawIDBuffer(0),
+    vertexCapacity(0), indexCapacity(0), drawIDCapacity(0), vertexCount(0), indexCount(0), rangeCount(0) {}
+
+void GeometryArena::Init(VertexFormat format_, unsigned int vertexCapacity_, unsigned int indexCapacity_) {
+    format = format_;
+    vertexCapacity = vertexCapacity_;
+    indexCapacity = indexCapacity_;
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glGenBuffers(1, &drawIDBuffer);
+
+    // uploads go through the copy targets so they never touch whatever VAO is bound
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * vertexFormatSize(format), NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(uint16_t), NULL, GL_STATIC_DRAW);
+
+    ReserveDrawIDs(1024);
+    setupVertexArray();
+}
+
+void GeometryArena::Release() {
+    if (VAO == 0)
+        return;
+
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    glDeleteBuffers(1, &drawIDBuffer);
+
+    VAO = 0;
+    VBO = 0;
+    EBO = 0;
+    drawIDBuffer = 0;
+    drawIDCapacity = 0;
+}
+
+void GeometryArena::Reset(VertexFormat format_) {
+    vertexCount = 0;
+    indexCount = 0;
+    rangeCount = 0;
+
+    if (format == format_)
+        return;
+
+    // same vertex capacity, different stride
+    format = format_;
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * vertexFormatSize(format), NULL, GL_STATIC_DRAW);
+    setupVertexArray();
+}
+
+bool GeometryArena::Add(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, ArenaRange& range) {
+    range.valid = false;
+    if (VAO == 0 || vertices.size() > 0x10000)
+        return false;
+
+    unsigned int stride = vertexFormatSize(format);
+    unsigned int newVertices = static_cast<unsigned int>(vertices.size());
+    unsigned int newIndices = static_cast<unsigned int>(indices.size());
+
+    bool moved = false;
+    if (vertexCount + newVertices > vertexCapacity) {
+        unsigned int capacity = std::max(vertexCapacity * 2, vertexCount + newVertices);
+        grow(VBO, vertexCount * stride, capacity * stride);
+        vertexCapacity = capacity;
+        moved = true;
+    }
+    if (indexCount + newIndices > indexCapacity) {
+        unsigned int capacity = std::max(indexCapacity * 2, indexCount + newIndices);
+        grow(EBO, indexCount * sizeof(uint16_t), capacity * sizeof(uint16_t));
+        indexCapacity = capacity;
+        moved = true;
+    }
+    if (moved)
+        setupVertexArray();
+
+    std::vector<unsigned char> vertexData = encodeVertices(vertices, format);
+    std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, vertexCount * stride, vertexData.size(), vertexData.data());
+    glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, indexCount * sizeof(uint16_t), shortIndices.size() * sizeof(uint16_t), shortIndices.data());
+
+    range.valid = true;
+    range.firstIndex = indexCount;
+    range.indexCount = newIndices;
+    range.baseVertex = static_cast<int>(vertexCount);
+
+    vertexCount += newVertices;
+    indexCount += newIndices;
+    rangeCount++;
+    return true;
+}
+
+void GeometryArena::ReserveDrawIDs(unsigned int drawCount) {
+    if (drawCount <= drawIDCapacity)
+        return;
+
+    drawIDCapacity = std::max(drawCount, drawIDCapacity * 2);
+    std::vector<GLuint> drawIDs(drawIDCapacity);
+    std::iota(drawIDs.begin(), drawIDs.end(), 0u);
+
+    // same buffer name, so the VAO keeps pointing at it
+    glBindBuffer(GL_COPY_WRITE_BUFFER, drawIDBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, drawIDs.size() * sizeof(GLuint), drawIDs.data(), GL_STATIC_DRAW);
+}
+
+void GeometryArena::Bind() const {
+    glBindVertexArray(VAO);
+}
+
+VertexFormat GeometryArena::GetFormat() const {
+    return format;
+}
+
+unsigned int GeometryArena::GetVertexBytes() const {
+    return vertexCount * vertexFormatSize(format);
+}
+
+unsigned int GeometryArena::GetIndexBytes() const {
+    return indexCount * sizeof(uint16_t);
+}
+
+unsigned int GeometryArena::GetRangeCount() const {
+    return rangeCount;
+}
+
+void GeometryArena::grow(unsigned int& buffer, unsigned int usedBytes, unsigned int newBytes) {
+    unsigned int grown;
+    glGenBuffers(1, &grown);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, newBytes, NULL, GL_STATIC_DRAW);
+
+    if (usedBytes > 0) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes);
+    }
+
+    glDeleteBuffers(1, &buffer);
+    buffer = grown;
+}
+
+void GeometryArena::setupVertexArray() {
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    setVertexAttributes(format);
+
+    glBindBuffer(GL_ARRAY_BUFFER, drawIDBuffer);
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(3);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+    glBindVertexArray(0);
+}
+#pragma endregion
+
+#pragma region IndirectRenderer Methods
+IndirectRenderer::IndirectRenderer() :
+    gpuCulling(true), occlusionCulling(true), batchCount(0), drawCount(0),
+    commandBuffer(0), drawBuffer(0), cullBuffer(0), counterBuffers{}, counterFences{}, counterBatchCounts{}, counterSlot(0),
+    streamBuffer(nullptr), drawOffset(-1), commandOffset(-1),
+    visibleCount(0), frustumCulledCount(0), occludedCount(0) {}
+
+void IndirectRenderer::Init() {
+    cullShader = Shader("assets/shaders/culling/Cull.comp");
+
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &drawBuffer);
+    glGenBuffers(1, &cullBuffer);
+    glGenBuffers(COUNTER_FRAMES, counterBuffers);
+}
+
+void IndirectRenderer::Release() {
+    if (commandBuffer == 0)
+        return;
+
+    glDeleteBuffers(1, &commandBuffer);
+    glDeleteBuffers(1, &drawBuffer);
+    glDeleteBuffers(1, &cullBuffer);
+    glDeleteBuffers(COUNTER_FRAMES, counterBuffers);
+    glDeleteProgram(cullShader.ID);
+
+    commandBuffer = 0;
+    drawBuffer = 0;
+    cullBuffer = 0;
+    for (int i = 0; i < COUNTER_FRAMES; i++) {
+        if (counterFences[i] != nullptr)
+            glDeleteSync(counterFences[i]);
+        counterBuffers[i] = 0;
+        counterFences[i] = nullptr;
+    }
+}
+
+void IndirectRenderer::SetStreamBuffer(StreamBuffer* streamBuffer_) {
+    streamBuffer = streamBuffer_;
+}
+
+void IndirectRenderer::Clear() {
+    for (unsigned int i = 0; i < batchCount; i++) {
+        batches[i].commands.clear();
+        batches[i].draws.clear();
+    }
+
+    batchCount = 0;
+    drawCount = 0;
+}
+
+bool IndirectRenderer::Add(Object3D& object, const Mesh& mesh, Shader& shader) {
+    if (!mesh.arenaRange.valid)
+        return false;
+
+    if (!object.drawn)
+        return true;
+
+    Batch* batch = nullptr;
+    for (unsigned int i = 0; i < batchCount; i++) {
+        Batch& candidate = batches[i];
+        if (candidate.shader->ID == shader.ID && candidate.texture1 == object.texture1 &&
+            candidate.texture2 == object.texture2 && candidate.texture3 == object.texture3) {
+            batch = &candidate;
+            break;
+        }
+    }
+
+    if (batch == nullptr) {
+        if (batchCount == batches.size())
+            batches.emplace_back();
+
+        batch = &batches[batchCount++];
+        batch->shader = &shader;
+        batch->texture1 = object.texture1;
+        batch->texture2 = object.texture2;
+        batch->texture3 = object.texture3;
+    }
+
+    const ArenaRange& range = mesh.arenaRange;
+    batch->commands.push_back({ range.indexCount, 1, range.firstIndex, range.baseVertex, 0 });
+    batch->draws.push_back({ object.GetModelMatrix(), glm::vec4(object.UVScale.x, object.UVScale.y, 0.0f, 0.0f),
+        object.GetBounds(), glm::vec4(object.color, 1.0f), object.lights });
+    drawCount++;
+
+    return true;
+}
+
+void IndirectRenderer::Prepare(const glm::mat4& viewProjection, const HiZBuffer* hiZ) {
+    if (drawCount == 0) {
+        visibleCount = 0;
+        frustumCulledCount = 0;
+        occludedCount = 0;
+        return;
+    }
+
+    // every batch's draws sit back to back, baseInstance is the global draw index
+    commands.clear();
+    draws.clear();
+    cullCommands.clear();
+    for (unsigned int i = 0; i < batchCount; i++) {
+        GLuint batchFirst = static_cast<GLuint>(draws.size());
+
+        for (unsigned int j = 0; j < batches[i].commands.size(); j++) {
+            DrawElementsIndirectCommand command = batches[i].commands[j];
+            command.baseInstance = static_cast<GLuint>(draws.size());
+
+            commands.push_back(command);
+            cullCommands.push_back({ command, i, batchFirst, 0 });
+            draws.push_back(batches[i].draws[j]);
+        }
+    }
+
+    unsigned int drawBytes = static_cast<unsigned int>(draws.size() * sizeof(DrawData));
+    drawOffset = -1;
+    if (streamBuffer != nullptr)
+        drawOffset = streamBuffer->BindStorage(0, draws.data(), drawBytes);
+
+    if (drawOffset < 0) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, drawBytes, draws.data(), GL_STREAM_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawBuffer);
+    }
+
+    // the culling pass writes its commands on the GPU, into our own buffer
+    commandOffset = -1;
+    if (gpuCulling) {
+        cull(viewProjection, hiZ);
+    }
+    else {
+        unsigned int commandBytes = static_cast<unsigned int>(commands.size() * sizeof(DrawElementsIndirectCommand));
+        if (streamBuffer != nullptr)
+            commandOffset = streamBuffer->Write(commands.data(), commandBytes, sizeof(GLuint));
+
+        if (commandOffset < 0) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, commandBytes, commands.data(), GL_STREAM_DRAW);
+        }
+
+        visibleCount = drawCount;
+        frustumCulledCount = 0;
+        occludedCount = 0;
+    }
+}
+
+void IndirectRenderer::Draw(GeometryArena& arena) {
+    if (drawCount == 0)
+        return;
+
+    bindBuffers(arena);
+
+    GLintptr commandBase = std::max<GLintptr>(commandOffset, 0);
+    unsigned int first = 0;
+    for (unsigned int i = 0; i < batchCount; i++) {
+        Batch& batch = batches[i];
+        batch.shader->use();
+
+        if (batch.texture1 != 0) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, batch.texture1);
+        }
+
+        if (batch.texture2 != 0) {
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, batch.texture2);
+        }
+
+        if (batch.texture3 != 0) {
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, batch.texture3);
+        }
+
+        unsigned int count = static_cast<unsigned int>(batch.commands.size());
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT,
+            (void*)(commandBase + first * sizeof(DrawElementsIndirectCommand)), count, 0);
+        first += count;
+    }
+
+    glBindVertexArray(0);
+}
+
+void IndirectRenderer::DrawGeometry(GeometryArena& arena, Shader& shader) {
+    if (drawCount == 0)
+        return;
+
+    bindBuffers(arena);
+
+    // no per-batch state, every command goes out in one multi-draw
+    shader.use();
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, (void*)std::max<GLintptr>(commandOffset, 0), drawCount, 0);
+
+    glBindVertexArray(0);
+}
+
+unsigned int IndirectRenderer::GetDrawCount() const {
+    return drawCount;
+}
+
+unsigned int IndirectRenderer::GetBatchCount() const {
+    return batchCount;
+}
+
+unsigned int IndirectRenderer::GetVisibleCount() const {
+    return visibleCount;
+}
+
+unsigned int IndirectRenderer::GetFrustumCulledCount() const {
+    return frustumCulledCount;
+}
+
+unsigned int IndirectRenderer::GetOccludedCount() const {
+    return occludedCount;
+}
+
+void IndirectRenderer::bindBuffers(GeometryArena& arena) {
+    arena.ReserveDrawIDs(drawCount);
+    arena.Bind();
+
+    // other passes may have rebound the indexed targets since Prepare
+    if (commandOffset >= 0)
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, streamBuffer->GetBuffer());
+    else
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+
+    if (drawOffset >= 0)
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 0, streamBuffer->GetBuffer(), drawOffset, drawCount * sizeof(DrawData));
+    else
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, drawBuffer);
+}
+
+void IndirectRenderer::cull(const glm::mat4& viewProjection, const HiZBuffer* hiZ) {
+    // earlier frames' counters, each only once its fence signaled so the read never waits.
+    // The slot about to be reused is the oldest, the last one read is the newest finished pass.
+    // Layout: frustum culled, occluded, then visible per batch.
+    for (int i = 0; i < COUNTER_FRAMES; i++) {
+        int slot = (counterSlot + i) % COUNTER_FRAMES;
+        if (counterFences[slot] == nullptr)
+            continue;
+
+        GLint status = GL_UNSIGNALED;
+        glGetSynciv(counterFences[slot], GL_SYNC_STATUS, 1, nullptr, &status);
+        if (status != GL_SIGNALED)
+            continue;
+
+        glDeleteSync(counterFences[slot]);
+        counterFences[slot] = nullptr;
+
+        counters.resize(counterBatchCounts[slot] + 2);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffers[slot]);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, counters.size() * sizeof(GLuint), counters.data());
+
+        frustumCulledCount = counters[0];
+        occludedCount = counters[1];
+        visibleCount = 0;
+        for (size_t j = 2; j < counters.size(); j++)
+            visibleCount += counters[j];
+    }
+
+    // still unfinished after a whole ring, its result is dropped
+    if (counterFences[counterSlot] != nullptr) {
+        glDeleteSync(counterFences[counterSlot]);
+        counterFences[counterSlot] = nullptr;
+    }
+
+    unsigned int cullBytes = static_cast<unsigned int>(cullCommands.size() * sizeof(CullCommand));
+    if (streamBuffer == nullptr || streamBuffer->BindStorage(1, cullCommands.data(), cullBytes) < 0) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, cullBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, cullBytes, cullCommands.data(), GL_STREAM_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, cullBuffer);
+    }
+
+    // zeroed commands draw nothing, so slots no visible draw claims are harmless
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, commandBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, cullCommands.size() * sizeof(DrawElementsIndirectCommand), NULL, GL_STREAM_DRAW);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, NULL);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, commandBuffer);
+
+    counters.assign(batchCount + 2, 0);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, counterBuffers[counterSlot]);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, counters.size() * sizeof(GLuint), counters.data(), GL_STREAM_READ);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, counterBuffers[counterSlot]);
+
+    glm::vec4 planes[6];
+    extractFrustumPlanes(viewProjection, planes);
+
+    cullShader.use();
+    for (int i = 0; i < 6; i++)
+        cullShader.setVec4("planes[" + std::to_string(i) + "]", planes[i]);
+    cullShader.setInt("drawCount", static_cast<int>(drawCount));
+
+    bool useHiZ = occlusionCulling && hiZ != nullptr && hiZ->IsValid();
+    cullShader.setBool("useHiZ", useHiZ);
+    if (useHiZ) {
+        cullShader.setInt("hiZ", 0);
+        cullShader.setMat4("hiZViewProjection", hiZ->GetViewProjection());
+        cullShader.setVec2("hiZSize", glm::vec2(static_cast<float>(hiZ->GetWidth()), static_cast<float>(hiZ->GetHeight())));
+        cullShader.setInt("hiZLevels", hiZ->GetLevelCount());
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, hiZ->GetTexture());
+    }
+
+    glDispatchCompute((drawCount + 63) / 64, 1, 1);
+
+    // the read-back is a buffer update, the fence covers the barrier
+    glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+    counterFences[counterSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    counterBatchCounts[counterSlot] = batchCount;
+    counterSlot = (counterSlot + 1) % COUNTER_FRAMES;
+}
+#pragma endregion
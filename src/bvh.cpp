@@ -0,0 +1,382 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <limits>
+
+const int BVH_MAX_LEAF_SIZE = 2;
+const int BVH_MAX_DEPTH = 60;
+const int BVH_BINS = 8;
+
+static float surfaceArea(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 e = max - min;
+    return e.x * e.y + e.y * e.z + e.z * e.x;
+}
+
+static bool intersectRay(const glm::vec3& origin, const glm::vec3& invDirection, const glm::vec3& min, const glm::vec3& max,
+    float maxT, float& tEntry)
+{
+    glm::vec3 t1 = (min - origin) * invDirection;
+    glm::vec3 t2 = (max - origin) * invDirection;
+    glm::vec3 tNear = glm::min(t1, t2);
+    glm::vec3 tFar = glm::max(t1, t2);
+
+    tEntry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float tExit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxT));
+
+    return tEntry <= tExit;
+}
+
+static bool overlaps(const BVHNode& node, const glm::vec3& min, const glm::vec3& max) {
+    return node.min.x <= max.x && node.max.x >= min.x &&
+        node.min.y <= max.y && node.max.y >= min.y &&
+        node.min.z <= max.z && node.max.z >= min.z;
+}
+
+#pragma region BVHNode Methods
+bool BVHNode::isLeaf() const {
+    return count > 0;
+}
+#pragma endregion
+
+#pragma region BVH Methods
+BVH::BVH() = default;
+
+void BVH::Build(const std::vector<glm::vec3>& mins, const std::vector<glm::vec3>& maxs) {
+    int itemCount = static_cast<int>(mins.size());
+
+    itemMin = mins;
+    itemMax = maxs;
+    centroids.resize(itemCount);
+    items.resize(itemCount);
+    itemLeaf.assign(itemCount, 0);
+
+    for (int i = 0; i < itemCount; i++) {
+        items[i] = i;
+        centroids[i] = (mins[i] + maxs[i]) * 0.5f;
+    }
+
+    nodes.clear();
+    parents.clear();
+    if (itemCount == 0)
+        return;
+
+    nodes.reserve(itemCount * 2);
+    parents.reserve(itemCount * 2);
+
+    BVHNode root;
+    root.leftFirst = 0;
+    root.count = itemCount;
+    nodes.push_back(root);
+    parents.push_back(-1);
+
+    updateNodeBounds(0);
+    subdivide(0, 0);
+
+    for (unsigned int n = 0; n < nodes.size(); n++) {
+        if (!nodes[n].isLeaf())
+            continue;
+
+        for (int i = 0; i < nodes[n].count; i++) {
+            itemLeaf[items[nodes[n].leftFirst + i]] = n;
+        }
+    }
+}
+
+void BVH::UpdateItem(int item, const glm::vec3& min, const glm::vec3& max) {
+    itemMin[item] = min;
+    itemMax[item] = max;
+    centroids[item] = (min + max) * 0.5f;
+
+    int n = itemLeaf[item];
+    updateNodeBounds(n);
+
+    for (n = parents[n]; n != -1; n = parents[n]) {
+        BVHNode& node = nodes[n];
+        const BVHNode& left = nodes[node.leftFirst];
+        const BVHNode& right = nodes[node.leftFirst + 1];
+
+        glm::vec3 newMin = glm::min(left.min, right.min);
+        glm::vec3 newMax = glm::max(left.max, right.max);
+        if (newMin == node.min && newMax == node.max)
+            break;
+
+        node.min = newMin;
+        node.max = newMax;
+    }
+}
+
+void BVH::SetItem(int item, const glm::vec3& min, const glm::vec3& max) {
+    itemMin[item] = min;
+    itemMax[item] = max;
+    centroids[item] = (min + max) * 0.5f;
+}
+
+// Children always come after their parent, so a reverse sweep sees them first.
+void BVH::Refit() {
+    for (int n = static_cast<int>(nodes.size()) - 1; n >= 0; n--) {
+        BVHNode& node = nodes[n];
+
+        if (node.isLeaf()) {
+            updateNodeBounds(n);
+            continue;
+        }
+
+        node.min = glm::min(nodes[node.leftFirst].min, nodes[node.leftFirst + 1].min);
+        node.max = glm::max(nodes[node.leftFirst].max, nodes[node.leftFirst + 1].max);
+    }
+}
+
+bool BVH::Raycast(const glm::vec3& origin, const glm::vec3& direction, float& maxT,
+    const std::function<bool(int item, float& maxT)>& intersect) const
+{
+    if (nodes.empty())
+        return false;
+
+    glm::vec3 invDirection = glm::vec3(1.0f) / direction;
+    bool hit = false;
+
+    int stack[BVH_MAX_DEPTH + 4];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+
+        float tEntry;
+        if (!intersectRay(origin, invDirection, node.min, node.max, maxT, tEntry))
+            continue;
+
+        if (node.isLeaf()) {
+            for (int i = 0; i < node.count; i++) {
+                if (intersect(items[node.leftFirst + i], maxT))
+                    hit = true;
+            }
+            continue;
+        }
+
+        // visit the nearer child first so later boxes are culled by the shorter maxT
+        int nearChild = node.leftFirst;
+        int farChild = node.leftFirst + 1;
+        float tNear, tFar;
+        bool hitNear = intersectRay(origin, invDirection, nodes[nearChild].min, nodes[nearChild].max, maxT, tNear);
+        bool hitFar = intersectRay(origin, invDirection, nodes[farChild].min, nodes[farChild].max, maxT, tFar);
+
+        if (hitNear && hitFar && tFar < tNear)
+            std::swap(nearChild, farChild);
+
+        if (hitNear || hitFar) {
+            stack[stackSize++] = farChild;
+            stack[stackSize++] = nearChild;
+        }
+    }
+
+    return hit;
+}
+
+void BVH::QueryAABB(const glm::vec3& min, const glm::vec3& max, std::vector<int>& results) const {
+    if (nodes.empty())
+        return;
+
+    int stack[BVH_MAX_DEPTH + 4];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+        if (!overlaps(node, min, max))
+            continue;
+
+        if (node.isLeaf()) {
+            for (int i = 0; i < node.count; i++) {
+                int item = items[node.leftFirst + i];
+                if (itemMin[item].x <= max.x && itemMax[item].x >= min.x &&
+                    itemMin[item].y <= max.y && itemMax[item].y >= min.y &&
+                    itemMin[item].z <= max.z && itemMax[item].z >= min.z)
+                    results.push_back(item);
+            }
+            continue;
+        }
+
+        stack[stackSize++] = node.leftFirst + 1;
+        stack[stackSize++] = node.leftFirst;
+    }
+}
+
+void BVH::QuerySphere(const glm::vec3& center, float radius, std::vector<int>& results) const {
+    if (nodes.empty())
+        return;
+
+    float radiusSq = radius * radius;
+    auto touches = [&center, radiusSq](const glm::vec3& min, const glm::vec3& max) {
+        glm::vec3 d = center - glm::clamp(center, min, max);
+        return glm::dot(d, d) <= radiusSq;
+    };
+
+    int stack[BVH_MAX_DEPTH + 4];
+    int stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0) {
+        const BVHNode& node = nodes[stack[--stackSize]];
+        if (!touches(node.min, node.max))
+            continue;
+
+        if (node.isLeaf()) {
+            for (int i = 0; i < node.count; i++) {
+                int item = items[node.leftFirst + i];
+                if (touches(itemMin[item], itemMax[item]))
+                    results.push_back(item);
+            }
+            continue;
+        }
+
+        stack[stackSize++] = node.leftFirst + 1;
+        stack[stackSize++] = node.leftFirst;
+    }
+}
+
+unsigned int BVH::GetNodeCount() const {
+    return static_cast<unsigned int>(nodes.size());
+}
+
+unsigned int BVH::GetItemCount() const {
+    return static_cast<unsigned int>(items.size());
+}
+
+const BVHNode& BVH::GetRoot() const {
+    return nodes[0];
+}
+
+float BVH::GetRootArea() const {
+    if (nodes.empty())
+        return 0.0f;
+
+    return surfaceArea(nodes[0].min, nodes[0].max);
+}
+
+void BVH::updateNodeBounds(int nodeIndex) {
+    BVHNode& node = nodes[nodeIndex];
+    node.min = glm::vec3(std::numeric_limits<float>::max());
+    node.max = glm::vec3(-std::numeric_limits<float>::max());
+
+    for (int i = 0; i < node.count; i++) {
+        int item = items[node.leftFirst + i];
+        node.min = glm::min(node.min, itemMin[item]);
+        node.max = glm::max(node.max, itemMax[item]);
+    }
+}
+
+void BVH::subdivide(int nodeIndex, int depth) {
+    if (nodes[nodeIndex].count <= BVH_MAX_LEAF_SIZE || depth >= BVH_MAX_DEPTH)
+        return;
+
+    int axis;
+    float splitPosition;
+    float splitCost = findBestSplit(nodes[nodeIndex], axis, splitPosition);
+
+    const BVHNode& node = nodes[nodeIndex];
+    float leafCost = node.count * surfaceArea(node.min, node.max);
+    if (splitCost >= leafCost)
+        return;
+
+    int first = node.leftFirst;
+    int count = node.count;
+    int* middle = std::partition(items.data() + first, items.data() + first + count,
+        [this, axis, splitPosition](int item) { return centroids[item][axis] < splitPosition; });
+
+    int leftCount = static_cast<int>(middle - (items.data() + first));
+    if (leftCount == 0 || leftCount == count)
+        return;
+
+    int leftIndex = static_cast<int>(nodes.size());
+
+    BVHNode left;
+    left.leftFirst = first;
+    left.count = leftCount;
+
+    BVHNode right;
+    right.leftFirst = first + leftCount;
+    right.count = count - leftCount;
+
+    nodes.push_back(left);
+    nodes.push_back(right);
+    parents.push_back(nodeIndex);
+    parents.push_back(nodeIndex);
+
+    nodes[nodeIndex].leftFirst = leftIndex;
+    nodes[nodeIndex].count = 0;
+
+    updateNodeBounds(leftIndex);
+    updateNodeBounds(leftIndex + 1);
+
+    subdivide(leftIndex, depth + 1);
+    subdivide(leftIndex + 1, depth + 1);
+}
+
+// Bins centroids along each axis and returns the cheapest SAH split between bins.
+float BVH::findBestSplit(const BVHNode& node, int& axis, float& splitPosition) const {
+    float bestCost = std::numeric_limits<float>::max();
+
+    for (int a = 0; a < 3; a++) {
+        float boundsMin = std::numeric_limits<float>::max();
+        float boundsMax = -std::numeric_limits<float>::max();
+        for (int i = 0; i < node.count; i++) {
+            float c = centroids[items[node.leftFirst + i]][a];
+            boundsMin = std::min(boundsMin, c);
+            boundsMax = std::max(boundsMax, c);
+        }
+
+        if (boundsMin == boundsMax)
+            continue;
+
+        glm::vec3 binMin[BVH_BINS];
+        glm::vec3 binMax[BVH_BINS];
+        int binCount[BVH_BINS] = {};
+        for (int b = 0; b < BVH_BINS; b++) {
+            binMin[b] = glm::vec3(std::numeric_limits<float>::max());
+            binMax[b] = glm::vec3(-std::numeric_limits<float>::max());
+        }
+
+        float scale = BVH_BINS / (boundsMax - boundsMin);
+        for (int i = 0; i < node.count; i++) {
+            int item = items[node.leftFirst + i];
+            int b = std::min(BVH_BINS - 1, static_cast<int>((centroids[item][a] - boundsMin) * scale));
+            binCount[b]++;
+            binMin[b] = glm::min(binMin[b], itemMin[item]);
+            binMax[b] = glm::max(binMax[b], itemMax[item]);
+        }
+
+        // sweep from both sides to get the area of every left/right split
+        float leftArea[BVH_BINS - 1], rightArea[BVH_BINS - 1];
+        int leftCount[BVH_BINS - 1], rightCount[BVH_BINS - 1];
+        glm::vec3 leftMin = glm::vec3(std::numeric_limits<float>::max()), leftMax = -leftMin;
+        glm::vec3 rightMin = leftMin, rightMax = leftMax;
+        int leftSum = 0, rightSum = 0;
+
+        for (int b = 0; b < BVH_BINS - 1; b++) {
+            leftSum += binCount[b];
+            leftCount[b] = leftSum;
+            leftMin = glm::min(leftMin, binMin[b]);
+            leftMax = glm::max(leftMax, binMax[b]);
+            leftArea[b] = leftSum > 0 ? surfaceArea(leftMin, leftMax) : 0.0f;
+
+            rightSum += binCount[BVH_BINS - 1 - b];
+            rightCount[BVH_BINS - 2 - b] = rightSum;
+            rightMin = glm::min(rightMin, binMin[BVH_BINS - 1 - b]);
+            rightMax = glm::max(rightMax, binMax[BVH_BINS - 1 - b]);
+            rightArea[BVH_BINS - 2 - b] = rightSum > 0 ? surfaceArea(rightMin, rightMax) : 0.0f;
+        }
+
+        for (int b = 0; b < BVH_BINS - 1; b++) {
+            float cost = leftCount[b] * leftArea[b] + rightCount[b] * rightArea[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                axis = a;
+                splitPosition = boundsMin + (b + 1) / scale;
+            }
+        }
+    }
+
+    return bestCost;
+}
+#pragma endregion
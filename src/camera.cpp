@@ -1,5 +1,21 @@
 #include "camera.h"
 
+void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+    // Gribb-Hartmann, rows of the matrix combined with the w row
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++)
+        rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+
+    for (int i = 0; i < 3; i++) {
+        planes[i * 2] = rows[3] + rows[i];
+        planes[i * 2 + 1] = rows[3] - rows[i];
+    }
+
+    for (int i = 0; i < 6; i++)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
 Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch) 
               : Front(glm::vec3(0.0f, 0.0f, -1.0f)), 
                 MovementSpeed(SPEED), 
@@ -31,6 +47,19 @@ glm::mat4 Camera::GetViewMatrix()
     return glm::lookAt(Position, Position + Front, Up);
 }
 
+// Direction of the ray from Position through a window point, y pointing down
+glm::vec3 Camera::ScreenPointToRay(float x, float y, float width, float height, const glm::mat4& projection)
+{
+    float ndcX = 2.0f * x / width - 1.0f;
+    float ndcY = 1.0f - 2.0f * y / height;
+
+    glm::mat4 inverseViewProjection = glm::inverse(projection * GetViewMatrix());
+    glm::vec4 nearPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+
+    return glm::normalize(glm::vec3(farPoint) / farPoint.w - glm::vec3(nearPoint) / nearPoint.w);
+}
+
 void Camera::ProcessKeyboard(CameraMovement direction, float deltaTime)
 {
     float velocity = MovementSpeed * deltaTime;
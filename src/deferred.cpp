@@ -0,0 +1,209 @@
+#include "deferred.h"
+
+#include <cmath>
+#include <iostream>
+#include <utility>
+
+// units 0 to 4 are the material maps and the shadow maps, bound by their owners
+const int ALBEDO_UNIT = 5;
+const int NORMAL_UNIT = 6;
+const int DEPTH_UNIT = 7;
+
+const int VOLUME_INDEX_COUNT = 60;
+
+#pragma region DeferredRenderer Methods
+DeferredRenderer::DeferredRenderer() :
+    FBO(0), albedoTexture(0), normalTexture(0), depthTexture(0), emptyVAO(0), volumeVAO(0), volumeVBO(0), volumeEBO(0),
+    width(0), height(0), volumeCount(0), targetFBO(0), targetViewport{ 0, 0, 0, 0 } {}
+
+void DeferredRenderer::Init() {
+    directionalShader = Shader("assets/shaders/outline/Fullscreen.vert", "assets/shaders/deferred/DirectionalLight.frag");
+    pointShader = Shader("assets/shaders/deferred/LightVolume.vert", "assets/shaders/deferred/PointLight.frag");
+
+    glGenFramebuffers(1, &FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+    glDrawBuffers(2, drawBuffers);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    glGenVertexArrays(1, &emptyVAO);
+
+    // Icosahedron scaled out until its faces touch the unit sphere, a volume that never
+    // cuts into the light's range at 20 triangles
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    glm::vec3 vertices[12] = {
+        glm::vec3(-1.0f, t, 0.0f), glm::vec3(1.0f, t, 0.0f), glm::vec3(-1.0f, -t, 0.0f), glm::vec3(1.0f, -t, 0.0f),
+        glm::vec3(0.0f, -1.0f, t), glm::vec3(0.0f, 1.0f, t), glm::vec3(0.0f, -1.0f, -t), glm::vec3(0.0f, 1.0f, -t),
+        glm::vec3(t, 0.0f, -1.0f), glm::vec3(t, 0.0f, 1.0f), glm::vec3(-t, 0.0f, -1.0f), glm::vec3(-t, 0.0f, 1.0f)
+    };
+    GLubyte indices[VOLUME_INDEX_COUNT] = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+    };
+
+    // the face center of a unit icosahedron is this far from its center
+    const float inradius = 0.7946544723f;
+    for (glm::vec3& vertex : vertices)
+        vertex = glm::normalize(vertex) / inradius;
+
+    // counter-clockwise from outside, whatever the table above says, culling depends on it
+    for (int i = 0; i < VOLUME_INDEX_COUNT; i += 3) {
+        const glm::vec3& a = vertices[indices[i]];
+        const glm::vec3& b = vertices[indices[i + 1]];
+        const glm::vec3& c = vertices[indices[i + 2]];
+        if (glm::dot(glm::cross(b - a, c - a), a + b + c) < 0.0f)
+            std::swap(indices[i + 1], indices[i + 2]);
+    }
+
+    glGenVertexArrays(1, &volumeVAO);
+    glGenBuffers(1, &volumeVBO);
+    glGenBuffers(1, &volumeEBO);
+
+    glBindVertexArray(volumeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, volumeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, volumeEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glBindVertexArray(0);
+}
+
+void DeferredRenderer::Release() {
+    if (FBO == 0)
+        return;
+
+    glDeleteFramebuffers(1, &FBO);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteVertexArrays(1, &volumeVAO);
+    glDeleteBuffers(1, &volumeVBO);
+    glDeleteBuffers(1, &volumeEBO);
+    glDeleteProgram(directionalShader.ID);
+    glDeleteProgram(pointShader.ID);
+
+    FBO = 0;
+    albedoTexture = 0;
+    normalTexture = 0;
+    depthTexture = 0;
+    emptyVAO = 0;
+    volumeVAO = 0;
+    volumeVBO = 0;
+    volumeEBO = 0;
+    width = 0;
+    height = 0;
+}
+
+void DeferredRenderer::BeginGeometry(const RenderTarget& albedo, const RenderTarget& normal) {
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+
+    // attached every frame, the pool may have deleted last frame's targets and handed
+    // their names out again
+    albedoTexture = albedo.texture;
+    normalTexture = normal.texture;
+    depthTexture = albedo.depthTexture; // positions are rebuilt from depth, nothing else stores them
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, albedoTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, normalTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::DEFERRED::G_BUFFER_INCOMPLETE" << std::endl;
+    width = albedo.width;
+    height = albedo.height;
+
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glDepthMask(GL_TRUE);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // the alpha channel holds specular intensity, blending would scale it
+    glDisable(GL_BLEND);
+
+    // albedo is encoded on write, alpha stays linear
+    glEnable(GL_FRAMEBUFFER_SRGB);
+}
+
+void DeferredRenderer::EndGeometry() {
+    glDisable(GL_FRAMEBUFFER_SRGB);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+    glEnable(GL_BLEND);
+}
+
+void DeferredRenderer::Light(const glm::mat4& view, const glm::mat4& projection, unsigned int pointLightCount) {
+    if (FBO == 0 || albedoTexture == 0)
+        return;
+
+    GLint depthFunc;
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+
+    glActiveTexture(GL_TEXTURE0 + ALBEDO_UNIT);
+    glBindTexture(GL_TEXTURE_2D, albedoTexture);
+    glActiveTexture(GL_TEXTURE0 + NORMAL_UNIT);
+    glBindTexture(GL_TEXTURE_2D, normalTexture);
+    glActiveTexture(GL_TEXTURE0 + DEPTH_UNIT);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    // fullscreen, overwrites color and depth wherever the G-buffer has geometry
+    glDisable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_ALWAYS);
+    glDepthMask(GL_TRUE);
+
+    bindGBuffer(directionalShader, view, projection);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // back faces pass where the scene is in front of the far side of the volume, with
+    // depth clamp so volumes reaching past the far plane aren't clipped open
+    volumeCount = pointLightCount;
+    if (volumeCount > 0) {
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        glDepthFunc(GL_GEQUAL);
+        glDepthMask(GL_FALSE);
+        glEnable(GL_DEPTH_CLAMP);
+        glCullFace(GL_FRONT);
+
+        bindGBuffer(pointShader, view, projection);
+        pointShader.setMat4("projection", projection);
+        glBindVertexArray(volumeVAO);
+        glDrawElementsInstanced(GL_TRIANGLES, VOLUME_INDEX_COUNT, GL_UNSIGNED_BYTE, (void*)0, volumeCount);
+
+        glCullFace(GL_BACK);
+        glDisable(GL_DEPTH_CLAMP);
+        glDepthMask(GL_TRUE);
+    }
+
+    glBindVertexArray(0);
+    glDepthFunc(depthFunc);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+}
+
+Shader& DeferredRenderer::GetDirectionalShader() {
+    return directionalShader;
+}
+
+Shader& DeferredRenderer::GetPointShader() {
+    return pointShader;
+}
+
+unsigned int DeferredRenderer::GetVolumeCount() const {
+    return volumeCount;
+}
+
+void DeferredRenderer::bindGBuffer(Shader& shader, const glm::mat4& view, const glm::mat4& projection) {
+    shader.use();
+    shader.setInt("gAlbedoSpecular", ALBEDO_UNIT);
+    shader.setInt("gNormal", NORMAL_UNIT);
+    shader.setInt("gDepth", DEPTH_UNIT);
+    shader.setMat4("view", view);
+    shader.setMat4("inverseViewProjection", glm::inverse(projection * view));
+    shader.setVec3("viewPos", glm::vec3(glm::inverse(view)[3]));
+}
+#pragma endregion
@@ -0,0 +1,59 @@
+#include "gputimer.h"
+
+#pragma region GpuTimer Methods
+GpuTimer::GpuTimer() : queries{}, pending{}, current(0), time(0.0f) {}
+
+void GpuTimer::Init() {
+    glGenQueries(QUERY_COUNT, queries);
+}
+
+void GpuTimer::Release() {
+    if (queries[0] == 0)
+        return;
+
+    glDeleteQueries(QUERY_COUNT, queries);
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        queries[i] = 0;
+        pending[i] = false;
+    }
+}
+
+void GpuTimer::Begin() {
+    if (queries[0] == 0)
+        return;
+
+    // the one about to be reused is the oldest, the last one read is the newest finished span
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        int query = (current + i) % QUERY_COUNT;
+        if (!pending[query])
+            continue;
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[query], GL_QUERY_RESULT, &elapsed);
+        time = static_cast<float>(elapsed / 1.0e6);
+        pending[query] = false;
+    }
+
+    // still unfinished after a whole ring, its result is dropped
+    pending[current] = false;
+    glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+}
+
+void GpuTimer::End() {
+    if (queries[0] == 0)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    pending[current] = true;
+    current = (current + 1) % QUERY_COUNT;
+}
+
+float GpuTimer::GetTime() const {
+    return time;
+}
+#pragma endregion
@@ -0,0 +1,188 @@
+#include "hdr.h"
+
+#include <algorithm>
+#include <cmath>
+
+const unsigned int EXPOSURE_BINDING = 7;
+
+#pragma region HDRPipeline Methods
+HDRPipeline::HDRPipeline() :
+    autoExposure(true), exposureCompensation(0.0f), adaptationSpeed(1.5f), minLogLuminance(-8.0f), maxLogLuminance(6.0f),
+    bloom(true), bloomThreshold(1.0f), bloomIntensity(0.05f), bloomLevels(5),
+    exposureBuffer(0), emptyVAO(0) {}
+
+void HDRPipeline::Init() {
+    histogramShader = Shader("assets/shaders/hdr/Histogram.comp");
+    exposureShader = Shader("assets/shaders/hdr/Exposure.comp");
+    downsampleShader = Shader("assets/shaders/outline/Fullscreen.vert", "assets/shaders/hdr/BloomDownsample.frag");
+    upsampleShader = Shader("assets/shaders/outline/Fullscreen.vert", "assets/shaders/hdr/BloomUpsample.frag");
+    tonemapShader = Shader("assets/shaders/outline/Fullscreen.vert", "assets/shaders/hdr/Tonemap.frag");
+
+    // empty bins, and a middle grey start for the adapted luminance
+    GLuint bins[HISTOGRAM_BINS] = {};
+    float startLuminance = 0.18f;
+
+    glGenBuffers(1, &exposureBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, exposureBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(bins) + sizeof(float), NULL, GL_DYNAMIC_COPY);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(bins), bins);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(bins), sizeof(float), &startLuminance);
+
+    glGenVertexArrays(1, &emptyVAO);
+}
+
+void HDRPipeline::Release() {
+    if (exposureBuffer == 0)
+        return;
+
+    glDeleteBuffers(1, &exposureBuffer);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteProgram(histogramShader.ID);
+    glDeleteProgram(exposureShader.ID);
+    glDeleteProgram(downsampleShader.ID);
+    glDeleteProgram(upsampleShader.ID);
+    glDeleteProgram(tonemapShader.ID);
+
+    exposureBuffer = 0;
+    emptyVAO = 0;
+}
+
+int HDRPipeline::GetBloomLevels(int sceneWidth, int sceneHeight, int* widths, int* heights) const {
+    if (!bloom)
+        return 0;
+
+    int count = 0;
+    int levelWidth = sceneWidth / 2;
+    int levelHeight = sceneHeight / 2;
+    for (; count < std::min(bloomLevels, MAX_BLOOM_LEVELS) && levelWidth > 0 && levelHeight > 0; count++) {
+        widths[count] = levelWidth;
+        heights[count] = levelHeight;
+        levelWidth /= 2;
+        levelHeight /= 2;
+    }
+    return count;
+}
+
+void HDRPipeline::RenderBloom(const RenderTarget& scene, const RenderTarget* levels, int levelCount) {
+    if (exposureBuffer == 0 || levelCount == 0)
+        return;
+
+    GLint targetFBO;
+    GLint targetViewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    // down, each level filtered from the one above it, the first only keeps what's bright
+    downsampleShader.use();
+    downsampleShader.setInt("source", 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    const RenderTarget* source = &scene;
+    for (int i = 0; i < levelCount; i++) {
+        downsampleShader.setVec2("sourceTexelSize", 1.0f / source->width, 1.0f / source->height);
+        downsampleShader.setVec2("targetTexelSize", 1.0f / levels[i].width, 1.0f / levels[i].height);
+        downsampleShader.setFloat("threshold", i == 0 ? bloomThreshold : -1.0f);
+        glBindTexture(GL_TEXTURE_2D, source->texture);
+        drawFullscreen(levels[i]);
+        source = &levels[i];
+    }
+
+    // and back up, every level adds a blurred copy of the one below
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+
+    upsampleShader.use();
+    upsampleShader.setInt("source", 0);
+    for (int i = levelCount - 1; i > 0; i--) {
+        upsampleShader.setVec2("sourceTexelSize", 1.0f / levels[i].width, 1.0f / levels[i].height);
+        upsampleShader.setVec2("targetTexelSize", 1.0f / levels[i - 1].width, 1.0f / levels[i - 1].height);
+        glBindTexture(GL_TEXTURE_2D, levels[i].texture);
+        drawFullscreen(levels[i - 1]);
+    }
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glBindVertexArray(0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+    if (!blend)
+        glDisable(GL_BLEND);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+}
+
+void HDRPipeline::Resolve(const RenderTarget& scene, const RenderTarget* bloom, float deltaTime) {
+    if (exposureBuffer == 0)
+        return;
+
+    GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, EXPOSURE_BINDING, exposureBuffer);
+    measureLuminance(scene, deltaTime);
+
+    // exposure, bloom, tonemap and gamma in one pass over the screen
+    tonemapShader.use();
+    tonemapShader.setInt("scene", 0);
+    tonemapShader.setInt("bloomTexture", 1);
+    tonemapShader.setBool("bloom", bloom != nullptr);
+    tonemapShader.setFloat("bloomIntensity", bloomIntensity);
+    tonemapShader.setBool("autoExposure", autoExposure);
+    tonemapShader.setFloat("exposure", std::exp2(exposureCompensation));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, scene.texture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, bloom != nullptr ? bloom->texture : 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    if (blend)
+        glEnable(GL_BLEND);
+    if (depthTest)
+        glEnable(GL_DEPTH_TEST);
+}
+
+void HDRPipeline::measureLuminance(const RenderTarget& scene, float deltaTime) {
+    if (!autoExposure)
+        return;
+
+    float range = maxLogLuminance - minLogLuminance;
+
+    histogramShader.use();
+    histogramShader.setInt("scene", 0);
+    histogramShader.setFloat("minLogLuminance", minLogLuminance);
+    histogramShader.setFloat("inverseLogLuminanceRange", 1.0f / range);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, scene.texture);
+    glDispatchCompute((scene.width + 15) / 16, (scene.height + 15) / 16, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+    // exponential approach, the same speed at any frame rate
+    exposureShader.use();
+    exposureShader.setFloat("minLogLuminance", minLogLuminance);
+    exposureShader.setFloat("logLuminanceRange", range);
+    exposureShader.setFloat("adaptation", 1.0f - std::exp(-deltaTime * adaptationSpeed));
+    exposureShader.setFloat("pixelCount", static_cast<float>(scene.width) * scene.height);
+    glDispatchCompute(1, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void HDRPipeline::drawFullscreen(const RenderTarget& destination) {
+    glBindFramebuffer(GL_FRAMEBUFFER, destination.FBO);
+    glViewport(0, 0, destination.width, destination.height);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+#pragma endregion
@@ -0,0 +1,164 @@
+#include "hiz.h"
+
+#include <algorithm>
+#include <iostream>
+
+#pragma region HiZBuffer Methods
+HiZBuffer::HiZBuffer() :
+    FBO(0), depthTexture(0), pyramidTexture(0), width(0), height(0), levelCount(0),
+    viewProjection(1.0f), valid(false), occluderCount(0), targetFBO(0), targetViewport{ 0, 0, 0, 0 } {}
+
+void HiZBuffer::Init(int screenWidth, int screenHeight) {
+    depthShader = Shader("assets/shaders/depth/DepthOnly.vert", "assets/shaders/depth/DepthOnly.frag");
+    copyShader = Shader("assets/shaders/culling/HiZCopy.comp");
+    downsampleShader = Shader("assets/shaders/culling/HiZDownsample.comp");
+
+    glGenFramebuffers(1, &FBO);
+    glGenTextures(1, &depthTexture);
+
+    Resize(screenWidth, screenHeight);
+}
+
+void HiZBuffer::Release() {
+    if (FBO == 0)
+        return;
+
+    glDeleteFramebuffers(1, &FBO);
+    glDeleteTextures(1, &depthTexture);
+    glDeleteTextures(1, &pyramidTexture);
+    glDeleteProgram(depthShader.ID);
+    glDeleteProgram(copyShader.ID);
+    glDeleteProgram(downsampleShader.ID);
+
+    FBO = 0;
+    depthTexture = 0;
+    pyramidTexture = 0;
+    width = 0;
+    height = 0;
+    levelCount = 0;
+    valid = false;
+}
+
+void HiZBuffer::Resize(int screenWidth, int screenHeight) {
+    if (screenWidth == width && screenHeight == height)
+        return;
+
+    // minimized windows report a zero-sized framebuffer
+    if (screenWidth <= 0 || screenHeight <= 0)
+        return;
+
+    width = screenWidth;
+    height = screenHeight;
+    valid = false;
+
+    levelCount = 1;
+    while ((std::max(width, height) >> levelCount) > 0)
+        levelCount++;
+
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // immutable storage, so image bindings of every level stay valid; a new size needs a new texture
+    glDeleteTextures(1, &pyramidTexture);
+    glGenTextures(1, &pyramidTexture);
+    glBindTexture(GL_TEXTURE_2D, pyramidTexture);
+    glTexStorage2D(GL_TEXTURE_2D, levelCount, GL_R32F, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::HIZ::DEPTH_FRAMEBUFFER_INCOMPLETE" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void HiZBuffer::BeginDepthPass(const glm::mat4& view, const glm::mat4& projection) {
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glViewport(0, 0, width, height);
+    glDepthMask(GL_TRUE);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    depthShader.use();
+    depthShader.setMat4("view", view);
+    depthShader.setMat4("projection", projection);
+
+    viewProjection = projection * view;
+    occluderCount = 0;
+}
+
+void HiZBuffer::AddOccluder(Object3D* object) {
+    object->DrawGeometry(depthShader);
+    occluderCount++;
+}
+
+void HiZBuffer::EndDepthPass() {
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+
+    buildPyramid();
+    valid = true;
+}
+
+bool HiZBuffer::IsValid() const {
+    return valid;
+}
+
+unsigned int HiZBuffer::GetTexture() const {
+    return pyramidTexture;
+}
+
+int HiZBuffer::GetWidth() const {
+    return width;
+}
+
+int HiZBuffer::GetHeight() const {
+    return height;
+}
+
+int HiZBuffer::GetLevelCount() const {
+    return levelCount;
+}
+
+const glm::mat4& HiZBuffer::GetViewProjection() const {
+    return viewProjection;
+}
+
+unsigned int HiZBuffer::GetOccluderCount() const {
+    return occluderCount;
+}
+
+void HiZBuffer::buildPyramid() {
+    // level 0 is a straight copy, depth formats can't be bound as images
+    copyShader.use();
+    copyShader.setInt("depth", 0);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, depthTexture);
+    glBindImageTexture(0, pyramidTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+    glDispatchCompute((width + 7) / 8, (height + 7) / 8, 1);
+
+    downsampleShader.use();
+    for (int level = 1; level < levelCount; level++) {
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        int levelWidth = std::max(width >> level, 1);
+        int levelHeight = std::max(height >> level, 1);
+
+        glBindImageTexture(0, pyramidTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+        glBindImageTexture(1, pyramidTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+    }
+}
+#pragma endregion
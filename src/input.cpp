@@ -1,57 +1,334 @@
 #include "input.h"
 
-#include <vector>
-#include <string>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
 
-bool ActionBinding::operator==(const ActionBinding& other) const {
-	return key == other.key && type == other.type;
+// "INPT" little-endian, bumped with the version whenever InputEvent changes
+static const unsigned int STREAM_MAGIC = 0x54504E49;
+static const unsigned int STREAM_VERSION = 2;
+
+static_assert(sizeof(InputEvent) == 16, "InputEvent is written to files as it is in memory");
+
+bool saveInputStream(const char* path, const InputStream& stream) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		std::cout << "ERROR::INPUT::FILE_NOT_OPENED " << path << std::endl;
+		return false;
+	}
+
+	unsigned int header[5] = { STREAM_MAGIC, STREAM_VERSION, static_cast<unsigned int>(stream.heldKeys.size()), stream.frameCount,
+		static_cast<unsigned int>(stream.events.size()) };
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(stream.heldKeys.data()), stream.heldKeys.size() * sizeof(short));
+	file.write(reinterpret_cast<const char*>(stream.frameTimes.data()), stream.frameTimes.size() * sizeof(float));
+	file.write(reinterpret_cast<const char*>(stream.events.data()), stream.events.size() * sizeof(InputEvent));
+
+	if (!file) {
+		std::cout << "ERROR::INPUT::FILE_NOT_WRITTEN " << path << std::endl;
+		return false;
+	}
+	return true;
 }
 
-bool KeyState::justPressed() const { return current && !previous; }
-bool KeyState::justReleased() const { return !current && previous; }
-bool KeyState::pressed() const { return current; }
+// Everything playback indexes with must be in range, and frames must not go backwards
+// or playback waits for a frame that already passed.
+static bool validStream(const InputStream& stream) {
+	for (short key : stream.heldKeys) {
+		if (key < 0 || key > GLFW_KEY_LAST)
+			return false;
+	}
+
+	unsigned int frame = 0;
+	for (const InputEvent& event : stream.events) {
+		if (event.frame < frame || event.frame >= stream.frameCount)
+			return false;
+		frame = event.frame;
+
+		if (event.source == INPUT_KEY && (event.code < 0 || event.code > GLFW_KEY_LAST))
+			return false;
+		if (event.source == INPUT_MOUSE_BUTTON && (event.code < 0 || event.code > GLFW_MOUSE_BUTTON_LAST))
+			return false;
+		if (event.source > INPUT_SCROLL)
+			return false;
+	}
+	return true;
+}
+
+bool loadInputStream(const char* path, InputStream& stream) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		std::cout << "ERROR::INPUT::FILE_NOT_OPENED " << path << std::endl;
+		return false;
+	}
+	unsigned long long fileSize = static_cast<unsigned long long>(file.tellg());
+	file.seekg(0);
+
+	unsigned int header[5];
+	file.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!file || header[0] != STREAM_MAGIC || header[1] != STREAM_VERSION) {
+		std::cout << "ERROR::INPUT::NOT_AN_INPUT_STREAM " << path << std::endl;
+		return false;
+	}
+
+	// the counts are checked against the file before anything is sized by them
+	unsigned long long expectedSize = sizeof(header) + static_cast<unsigned long long>(header[2]) * sizeof(short) +
+		static_cast<unsigned long long>(header[3]) * sizeof(float) + static_cast<unsigned long long>(header[4]) * sizeof(InputEvent);
+	if (expectedSize != fileSize) {
+		std::cout << "ERROR::INPUT::SIZE_MISMATCH " << path << std::endl;
+		return false;
+	}
+
+	InputStream loaded;
+	loaded.heldKeys.resize(header[2]);
+	loaded.frameCount = header[3];
+	loaded.frameTimes.resize(header[3]);
+	loaded.events.resize(header[4]);
+	file.read(reinterpret_cast<char*>(loaded.heldKeys.data()), loaded.heldKeys.size() * sizeof(short));
+	file.read(reinterpret_cast<char*>(loaded.frameTimes.data()), loaded.frameTimes.size() * sizeof(float));
+	file.read(reinterpret_cast<char*>(loaded.events.data()), loaded.events.size() * sizeof(InputEvent));
+
+	if (!file) {
+		std::cout << "ERROR::INPUT::FILE_TRUNCATED " << path << std::endl;
+		return false;
+	}
 
-void Input::Process(GLFWwindow* window) {
-	for (int key = GLFW_KEY_SPACE; key <= GLFW_KEY_LAST; ++key) {
-		KeyState& state = keyStates[key];
-		state.previous = state.current;
-		state.current = (glfwGetKey(window, key) == GLFW_PRESS);
+	if (!validStream(loaded)) {
+		std::cout << "ERROR::INPUT::INVALID_STREAM " << path << std::endl;
+		return false;
 	}
 
-	for (auto& [actionBinding, action] : actions) {
-		const KeyState& s = keyStates[actionBinding.key];
+	stream = std::move(loaded);
+	return true;
+}
+
+void Input::Init(GLFWwindow* window_, GLFWcursorposfun cursorHandler_, GLFWmousebuttonfun mouseButtonHandler_,
+	GLFWscrollfun scrollHandler_) {
+	window = window_;
+	cursorHandler = cursorHandler_;
+	mouseButtonHandler = mouseButtonHandler_;
+	scrollHandler = scrollHandler_;
+
+	glfwSetKeyCallback(window, keyCallback);
+	glfwSetCursorPosCallback(window, cursorPosCallback);
+	glfwSetMouseButtonCallback(window, mouseButtonCallback);
+	glfwSetScrollCallback(window, scrollCallback);
+}
+
+void Input::Process(float deltaTime) {
+	previous = current;
 
-		switch (actionBinding.type) {
-			case InputEventType::JUST_PRESSED:
-				if (s.justPressed()) action();
-				break;
-			case InputEventType::JUST_RELEASED:
-				if (s.justReleased()) action();
-				break;
-			case InputEventType::PRESSED:
-				if (s.pressed()) action();
-				break;
+	if (playing) {
+		// live events are dropped, the stream is the keyboard and mouse
+		pending.clear();
+		while (playbackEvent < playback.events.size() && playback.events[playbackEvent].frame == playbackFrame) {
+			const InputEvent& event = playback.events[playbackEvent++];
+			pending.push_back(event);
 		}
 	}
+
+	for (InputEvent& event : pending) {
+		if (recording) {
+			event.frame = recorded.frameCount;
+			recorded.events.push_back(event);
+		}
+		dispatch(event);
+	}
+	pending.clear();
+
+	for (short key : heldKeys)
+		actions[bindings[PRESSED][key]]();
+
+	if (recording) {
+		recorded.frameTimes.push_back(deltaTime);
+		recorded.frameCount++;
+	}
+
+	if (playing && ++playbackFrame >= playback.frameCount)
+		StopPlayback();
+}
+
+float Input::GetDeltaTime(float measured) {
+	if (!playing)
+		return measured;
+	if (playbackDeltaTime > 0.0f)
+		return playbackDeltaTime;
+	if (playbackFrame < playback.frameTimes.size())
+		return playback.frameTimes[playbackFrame];
+	return measured;
 }
 
 void Input::BindAction(int key, InputEventType type, std::function<void()> callback) {
-	bool exists = false;
+	if (key < 0 || key > GLFW_KEY_LAST)
+		return;
 
-	for (auto& [actionBinding, action] : actions) {
-		if (actionBinding.type == type && actionBinding.key == key) {
-			actions[actionBinding] = callback;
-			exists = true;
-		}
+	short& index = bindings[type][key];
+	if (index >= 0) {
+		actions[index] = std::move(callback);
+		return;
+	}
+
+	index = static_cast<short>(actions.size());
+	actions.push_back(std::move(callback));
+
+	if (type == PRESSED && current[key])
+		heldKeys.push_back(static_cast<short>(key));
+}
+
+bool Input::Pressed(int key) { return current[key]; }
+bool Input::JustPressed(int key) { return current[key] && !previous[key]; }
+bool Input::JustReleased(int key) { return !current[key] && previous[key]; }
+
+void Input::GetCursorPosition(double& x, double& y) {
+	x = cursorX;
+	y = cursorY;
+}
+
+void Input::StartRecording() {
+	recorded = InputStream();
+	recording = true;
+
+	// keys already down are kept apart, as events they'd run edge bindings the recorded
+	// run never ran
+	for (int key = 0; key <= GLFW_KEY_LAST; key++) {
+		if (current[key])
+			recorded.heldKeys.push_back(static_cast<short>(key));
 	}
+}
+
+InputStream Input::StopRecording() {
+	recording = false;
+	return std::move(recorded);
+}
+
+bool Input::IsRecording() {
+	return recording;
+}
+
+void Input::StartPlayback(const InputStream& stream, float fixedDeltaTime) {
+	releaseAll();
+	playback = stream;
+	playbackFrame = 0;
+	playbackEvent = 0;
+	playbackDeltaTime = fixedDeltaTime;
+	playing = playback.frameCount > 0;
+	if (!playing)
+		return;
+
+	for (short key : playback.heldKeys) {
+		current[key] = true;
+		if (bindings[PRESSED][key] >= 0)
+			heldKeys.push_back(key);
+	}
+	previous = current;
+}
+
+void Input::StopPlayback() {
+	if (!playing)
+		return;
+
+	playing = false;
+	releaseAll();
+}
+
+bool Input::IsPlaying() {
+	return playing;
+}
+
+unsigned int Input::GetPlaybackFrame() {
+	return playbackFrame;
+}
+
+void Input::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	// repeats change nothing, unknown keys have no bit
+	if (action == GLFW_REPEAT || key < 0 || key > GLFW_KEY_LAST)
+		return;
+
+	pending.push_back({ 0, INPUT_KEY, action == GLFW_PRESS, static_cast<short>(key), 0.0f, 0.0f });
+}
+
+void Input::cursorPosCallback(GLFWwindow* window, double xpos, double ypos) {
+	pending.push_back({ 0, INPUT_CURSOR, false, 0, static_cast<float>(xpos), static_cast<float>(ypos) });
+}
+
+void Input::mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
+	pending.push_back({ 0, INPUT_MOUSE_BUTTON, action == GLFW_PRESS, static_cast<short>(button), 0.0f, 0.0f });
+}
 
-	if (!exists) {
-		ActionBinding actionBinding;
-		actionBinding.key = key;
-		actionBinding.type = type;
-		actions[actionBinding] = std::move(callback);
+void Input::scrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
+	pending.push_back({ 0, INPUT_SCROLL, false, 0, static_cast<float>(xoffset), static_cast<float>(yoffset) });
+}
+
+void Input::dispatch(const InputEvent& event) {
+	switch (event.source) {
+	case INPUT_KEY:
+		applyEvent(event.code, event.down);
+		break;
+	case INPUT_MOUSE_BUTTON:
+		// modifiers aren't kept, nothing reads them
+		if (mouseButtonHandler != nullptr)
+			mouseButtonHandler(window, event.code, event.down ? GLFW_PRESS : GLFW_RELEASE, 0);
+		break;
+	case INPUT_CURSOR:
+		cursorX = event.x;
+		cursorY = event.y;
+		if (cursorHandler != nullptr)
+			cursorHandler(window, event.x, event.y);
+		break;
+	case INPUT_SCROLL:
+		if (scrollHandler != nullptr)
+			scrollHandler(window, event.x, event.y);
+		break;
 	}
 }
 
-std::array<KeyState, GLFW_KEY_LAST + 1> Input::keyStates;
-std::unordered_map<ActionBinding, std::function<void()>> Input::actions;
\ No newline at end of file
+void Input::applyEvent(int key, bool down) {
+	if (current[key] == down)
+		return;
+	current[key] = down;
+
+	short edge = bindings[down ? JUST_PRESSED : JUST_RELEASED][key];
+	if (edge >= 0)
+		actions[edge]();
+
+	if (bindings[PRESSED][key] < 0)
+		return;
+
+	auto held = std::find(heldKeys.begin(), heldKeys.end(), static_cast<short>(key));
+	if (down && held == heldKeys.end())
+		heldKeys.push_back(static_cast<short>(key));
+	else if (!down && held != heldKeys.end())
+		heldKeys.erase(held);
+}
+
+void Input::releaseAll() {
+	current.reset();
+	previous.reset();
+	pending.clear();
+	heldKeys.clear();
+}
+
+std::bitset<GLFW_KEY_LAST + 1> Input::current;
+std::bitset<GLFW_KEY_LAST + 1> Input::previous;
+std::vector<InputEvent> Input::pending;
+GLFWwindow* Input::window = nullptr;
+GLFWcursorposfun Input::cursorHandler = nullptr;
+GLFWmousebuttonfun Input::mouseButtonHandler = nullptr;
+GLFWscrollfun Input::scrollHandler = nullptr;
+double Input::cursorX = 0.0;
+double Input::cursorY = 0.0;
+std::array<std::array<short, GLFW_KEY_LAST + 1>, INPUT_EVENT_TYPE_COUNT> Input::bindings = []() {
+	std::array<std::array<short, GLFW_KEY_LAST + 1>, INPUT_EVENT_TYPE_COUNT> unbound;
+	for (auto& typeBindings : unbound)
+		typeBindings.fill(-1);
+	return unbound;
+}();
+std::vector<std::function<void()>> Input::actions;
+std::vector<short> Input::heldKeys;
+bool Input::recording = false;
+InputStream Input::recorded;
+bool Input::playing = false;
+InputStream Input::playback;
+unsigned int Input::playbackFrame = 0;
+unsigned int Input::playbackEvent = 0;
+float Input::playbackDeltaTime = 0.0f;
\ No newline at end of file
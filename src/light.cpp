@@ -1,5 +1,10 @@
 #include "light.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
 DirectionLight::DirectionLight(glm::vec3 dir_, glm::vec3 ambient_, glm::vec3 diffuse_, glm::vec3 specular_) :
         direction(dir_), 
         ambient(ambient_), 
@@ -174,14 +179,50 @@ PointLight::PointLight(int id_, float radius, glm::vec3 ambient_, glm::vec3 diff
         }
     }
 
-void PointLight::UpdateRadius(float radius) {
-    float radiusLight = 0.01f;
+void PointLight::UpdateRadius(float radius, float cutoff) {
+    // 1 / (1 + d / s)^2 is the falloff of a sphere light of radius s, pick the s
+    // that reaches the cutoff at `radius`
+    float falloff = std::sqrt(brightness() / cutoff);
 
     constant = 1.0f;
-    linear = 0.22f;
-    quadratic = 0.2f;
-    //linear = (1 - radiusLight) / radiusLight * (2 / radius);
-    //quadratic = (1 - radiusLight) / radiusLight * (1 / pow(radius, 2));
+    linear = 0.0f;
+    quadratic = 0.0f;
+
+    // never brighter than the cutoff, any attenuation gives a range of 0
+    if (falloff <= 1.0f)
+        return;
+
+    float sourceRadius = std::max(radius, 0.01f) / (falloff - 1.0f);
+    linear = 2.0f / sourceRadius;
+    quadratic = 1.0f / (sourceRadius * sourceRadius);
+}
+
+float PointLight::GetRadius(float cutoff) const {
+    // constant + linear * d + quadratic * d^2 = brightness / cutoff
+    float target = brightness() / cutoff;
+    if (target <= constant)
+        return 0.0f;
+
+    if (quadratic > 0.0f)
+        return (-linear + std::sqrt(linear * linear + 4.0f * quadratic * (target - constant))) / (2.0f * quadratic);
+
+    if (linear > 0.0f)
+        return (target - constant) / linear;
+
+    return std::numeric_limits<float>::infinity();
+}
+
+PointLightData PointLight::GetData() const {
+    PointLightData data = {};
+    data.attenuation = glm::vec4(constant, linear, quadratic, 0.0f);
+    if (!shown)
+        return data;
+
+    data.position = glm::vec4(position, GetRadius());
+    data.ambient = glm::vec4(ambient, 0.0f);
+    data.diffuse = glm::vec4(diffuse, 0.0f);
+    data.specular = glm::vec4(specular, 0.0f);
+    return data;
 }
 
 void PointLight::Setup(Shader& shader, bool use, int id_) {
@@ -227,6 +268,11 @@ void PointLight::Update(Shader& shader, bool use, int id_) {
     }
 
     shader.setVec3(Id + "position", position);
+
+    // the range can change at runtime, see UpdateRadius
+    shader.setFloat(Id + "constant", constant);
+    shader.setFloat(Id + "linear", linear);
+    shader.setFloat(Id + "quadratic", quadratic);
 }
 
 void PointLight::Update(std::vector<Shader>& shaders, bool use, int id_) {
@@ -238,9 +284,9 @@ void PointLight::Update(std::vector<Shader>& shaders, bool use, int id_) {
 
         std::string Id;
         if (id_ == -1)
-            Id = "spotLights[" + std::to_string(id) + "].";
+            Id = "pointLights[" + std::to_string(id) + "].";
         else
-            Id = "spotLights[" + std::to_string(id_) + "].";
+            Id = "pointLights[" + std::to_string(id_) + "].";
 
         if (isShowing && !shown) {
             shader.setVec3(Id + "ambient", glm::vec3(0.0f, 0.0f, 0.0f));
@@ -252,6 +298,10 @@ void PointLight::Update(std::vector<Shader>& shaders, bool use, int id_) {
         }
 
         shader.setVec3(Id + "position", position);
+
+        shader.setFloat(Id + "constant", constant);
+        shader.setFloat(Id + "linear", linear);
+        shader.setFloat(Id + "quadratic", quadratic);
     }
 
     if (isShowing && !shown) {
@@ -260,4 +310,39 @@ void PointLight::Update(std::vector<Shader>& shaders, bool use, int id_) {
     else if (!isShowing && shown) {
         isShowing = true;
     }
+}
+
+float PointLight::brightness() const {
+    float brightest = std::max(std::max(ambient.x, diffuse.x), specular.x);
+    brightest = std::max(brightest, std::max(std::max(ambient.y, diffuse.y), specular.y));
+    return std::max(brightest, std::max(std::max(ambient.z, diffuse.z), specular.z));
+}
+
+
+glm::ivec4 selectLights(const std::vector<glm::vec4>& lightSpheres, const glm::vec4& bounds) {
+    // (distance over range, index) of every light that reaches the sphere
+    std::pair<float, int> reached[MAX_OBJECT_LIGHTS + 1];
+    int reachedCount = 0;
+
+    for (int i = 0; i < static_cast<int>(lightSpheres.size()); i++) {
+        const glm::vec4& light = lightSpheres[i];
+        if (light.w <= 0.0f)
+            continue;
+
+        float distance = glm::length(glm::vec3(light) - glm::vec3(bounds));
+        if (distance >= light.w + bounds.w)
+            continue;
+
+        // insertion into the short sorted list, the farthest falls off the end
+        std::pair<float, int> candidate(distance / light.w, i);
+        int slot = reachedCount < MAX_OBJECT_LIGHTS ? reachedCount++ : MAX_OBJECT_LIGHTS;
+        reached[slot] = candidate;
+        for (; slot > 0 && reached[slot] < reached[slot - 1]; slot--)
+            std::swap(reached[slot], reached[slot - 1]);
+    }
+
+    glm::ivec4 lights(-1);
+    for (int i = 0; i < reachedCount; i++)
+        lights[i] = reached[i].second;
+    return lights;
 }
\ No newline at end of file
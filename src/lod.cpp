@@ -0,0 +1,142 @@
+#include "lod.h"
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+
+float projectedSize(const glm::vec3& center, float radius, const glm::vec3& cameraPosition, float fovY) {
+    float distance = glm::length(center - cameraPosition);
+    if (distance <= radius)
+        return 1.0f;
+
+    return radius / (distance * tanf(fovY * 0.5f));
+}
+
+#pragma region LODGroup Methods
+LODGroup::LODGroup(float bias_, float hysteresis_) :
+    bias(bias_), hysteresis(hysteresis_), trianglesSubmitted(0), trianglesFullDetail(0) {}
+
+void LODGroup::AddLevel(Mesh& mesh, float minScreenSize) {
+    levels.push_back({ &mesh, minScreenSize, 0 });
+    buckets.emplace_back();
+}
+
+void LODGroup::Clear() {
+    for (unsigned int i = 0; i < levels.size(); i++) {
+        buckets[i].clear();
+        levels[i].instanceCount = 0;
+    }
+
+    previousLevels.swap(currentLevels);
+    currentLevels.clear();
+
+    trianglesSubmitted = 0;
+    trianglesFullDetail = 0;
+}
+
+void LODGroup::Submit(Object3D* object, const glm::vec3& cameraPosition, float fovY) {
+    if (levels.empty() || !object->drawn)
+        return;
+
+    int level = updateLevel(object, cameraPosition, fovY);
+    buckets[level].push_back(object);
+    count(level);
+}
+
+Mesh& LODGroup::Select(Object3D* object, const glm::vec3& cameraPosition, float fovY) {
+    return *levels[updateLevel(object, cameraPosition, fovY)].mesh;
+}
+
+void LODGroup::Count(Object3D* object) {
+    auto it = currentLevels.find(object);
+    if (it != currentLevels.end())
+        count(it->second);
+}
+
+void LODGroup::Draw() {
+    for (unsigned int i = 0; i < levels.size(); i++) {
+        if (buckets[i].empty())
+            continue;
+
+        const Mesh& mesh = *levels[i].mesh;
+        glBindVertexArray(mesh.VAO);
+
+        for (Object3D* object : buckets[i]) {
+            object->Bind();
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, mesh.indexType, 0);
+        }
+    }
+}
+
+void LODGroup::DrawGeometry(Shader& shader) {
+    shader.use();
+
+    for (unsigned int i = 0; i < levels.size(); i++) {
+        if (buckets[i].empty())
+            continue;
+
+        const Mesh& mesh = *levels[i].mesh;
+        glBindVertexArray(mesh.VAO);
+
+        for (Object3D* object : buckets[i]) {
+            shader.setMat4("model", object->GetModelMatrix());
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, mesh.indexType, 0);
+        }
+    }
+}
+
+unsigned int LODGroup::GetLevelCount() const {
+    return static_cast<unsigned int>(levels.size());
+}
+
+const LODLevel& LODGroup::GetLevel(unsigned int level) const {
+    return levels[level];
+}
+
+unsigned int LODGroup::GetTrianglesSubmitted() const {
+    return trianglesSubmitted;
+}
+
+unsigned int LODGroup::GetTrianglesFullDetail() const {
+    return trianglesFullDetail;
+}
+
+// A level is kept until the size leaves its band by more than the hysteresis,
+// so an instance sitting on a threshold doesn't flicker between two meshes.
+int LODGroup::selectLevel(float screenSize, int currentLevel) const {
+    int last = static_cast<int>(levels.size()) - 1;
+
+    if (currentLevel < 0) {
+        int level = 0;
+        while (level < last && screenSize < levels[level].minScreenSize)
+            level++;
+        return level;
+    }
+
+    int level = std::min(currentLevel, last);
+    while (level > 0 && screenSize > levels[level - 1].minScreenSize * (1.0f + hysteresis))
+        level--;
+    while (level < last && screenSize < levels[level].minScreenSize * (1.0f - hysteresis))
+        level++;
+
+    return level;
+}
+
+int LODGroup::updateLevel(Object3D* object, const glm::vec3& cameraPosition, float fovY) {
+    float radius = std::max(std::max(object->scale.x, object->scale.y), object->scale.z);
+    float screenSize = projectedSize(object->position, radius, cameraPosition, fovY) * bias;
+
+    // new instances start at the level their size asks for, without hysteresis
+    auto it = previousLevels.find(object);
+    int level = selectLevel(screenSize, it != previousLevels.end() ? it->second : -1);
+    currentLevels[object] = level;
+    return level;
+}
+
+void LODGroup::count(int level) {
+    levels[level].instanceCount++;
+    trianglesSubmitted += levels[level].mesh->indexCount / 3;
+    trianglesFullDetail += levels[0].mesh->indexCount / 3;
+}
+#pragma endregion
@@ -6,6 +6,23 @@
 #include "shader.h"
 #include "camera.h"
 #include "light.h"
+#include "physics.h"
+#include "outline.h"
+#include "mesh.h"
+#include "lod.h"
+#include "arena.h"
+#include "hiz.h"
+#include "occlusion.h"
+#include "overdraw.h"
+#include "streambuffer.h"
+#include "shadow.h"
+#include "deferred.h"
+#include "gputimer.h"
+#include "tiledlights.h"
+#include "hdr.h"
+#include "rendergraph.h"
+#include "skybox.h"
+#include "sphericalharmonics.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -17,6 +34,10 @@
 
 #include <stb_image/stb_image.h>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <random>
 #include <iostream>
 #include <string>
@@ -30,9 +51,11 @@ using std::string;
 const unsigned int SCR_WIDTH = 1920;
 const unsigned int SCR_HEIGHT = 1080;
 GLFWwindow* window;
+int framebufferWidth, framebufferHeight;
 
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
+double simulationTime = 0.0; // sum of every deltaTime, animation follows it so replays match
 
 // ------------------------------------------------
 // Systems
@@ -51,6 +74,18 @@ static bool lampOn = true;
 // Keys
 bool pause = false;
 
+InputStream recordedInput; // replayed through the same bindings and callbacks, for repeatable runs
+
+// Regression runs from the command line: --record saves everything from the first frame
+// on when the window closes, --replay plays a file from the first frame and quits after
+// printing the frame times, --step fixes its delta time and --histogram saves them.
+const char* recordPath = nullptr;
+const char* replayPath = nullptr;
+float replayStep = 0.0f; // seconds, 0 keeps the recorded delta times
+const char* histogramPath = nullptr;
+bool replayRun = false;
+vector<float> replayFrameTimes; // ms, wall clock of every replayed frame
+
 // Mouse
 double lastX = SCR_WIDTH / 2.0f;
 double lastY = SCR_HEIGHT / 2.0f;
@@ -61,9 +96,12 @@ bool cursorHidden = true;
 // Shaders
 Shader litShader;
 Shader litTexShader;
+Shader litIndirectShader;
+Shader litTexIndirectShader;
+Shader prepassShader;
+Shader prepassIndirectShader;
 Shader lightShader;
 Shader colorShader;
-Shader skyboxShader;
 
 // --------------------------------------------------------
 // Camera
@@ -72,19 +110,103 @@ Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
 // Lights
 DirectionLight dirLight(glm::vec3(-0.2f, -1.0f, -0.3f), glm::vec3(0.3f),
 	glm::vec3(0.4f, 0.4f, 0.4f), glm::vec3(0.5f, 0.5f, 0.5f));
-SpotLight spotLights[1]; // NR_POINT_LIGHTS in shaders
-PointLight pointLights[1]; // NR_SPOT_LIGHTS in shaders
-
-// Skybox
-Object3D* skybox;
+SpotLight spotLights[1]; // NR_SPOT_LIGHTS in shaders
+vector<PointLight> pointLights(1); // the lamp, then the extra lights
+int extraLightCount = 0; // scattered over the floor by scatterLights
+float lampRange = 20.0f;
+vector<glm::vec4> lightSpheres; // position and range of every point light, this frame
+vector<PointLightData> pointLightData; // what the lit shaders read at POINT_LIGHT_BINDING, this frame
+unsigned int pointLightBuffer = 0; // holds them instead when the stream buffer's region is full
+unsigned int lightAssignmentCount = 0;
+
+// Skybox, drawn after the opaque passes so early-Z rejects what they cover
+Skybox skybox;
+
+// Meshes
+MeshCache meshCache;
+LODGroup sphereLODs;
+bool useLOD = true;
+GeometryArena geometryArena;
+IndirectRenderer indirectRenderer;
+bool useIndirect = true;
+
+// Occlusion
+enum OcclusionMode { OCCLUSION_OFF, OCCLUSION_GPU, OCCLUSION_CPU };
+const char* occlusionModeNames[] = { "Off", "GPU Hi-Z", "CPU Raster" };
+int occlusionMode = OCCLUSION_GPU;
+HiZBuffer hiZBuffer;
+SoftwareOcclusion softwareOcclusion(256, 128);
+unsigned int cpuOccludedCount = 0;
+
+// Opaque passes
+vector<Object3D*> opaqueObjects; // drawn one by one, everything else goes through the LOD group or the arena
+bool depthPrepass = true;
+bool showOverdraw = false;
+OverdrawPass overdrawPass(8.0f);
+
+// Per-frame uploads, one fenced region per frame in flight
+StreamBuffer streamBuffer;
+
+// Shadows
+CascadedShadowMap shadowMap(3, 2048);
+const int shadowResolutions[] = { 512, 1024, 2048, 4096 };
+const char* shadowResolutionNames[] = { "512", "1024", "2048", "4096" };
+int shadowResolution = 2;
+vector<Object3D*> shadowCasters; // culled per cascade, independent of the camera
+PointShadowMap pointShadowMap(1024);
+
+// Shading paths, and the benchmark that times them against each other at a sweep of light counts
+enum ShadingPath { SHADING_FORWARD, SHADING_FORWARD_PLUS, SHADING_DEFERRED, SHADING_PATH_COUNT };
+const char* shadingPathNames[] = { "Forward", "Forward+", "Deferred" };
+int shadingPath = SHADING_FORWARD;
+DeferredRenderer deferredRenderer;
+TiledLightCuller tiledLightCuller(32.0f);
+bool showLightTiles = false;
+GpuTimer shadingTimer; // from the pre-pass to the last light, on every path
+
+// HDR, everything up to the tonemap renders into the graph's scene target
+HDRPipeline hdrPipeline;
+
+// The frame's GPU passes, rebuilt every frame. Resources owned by the systems above are
+// imported once. Per-frame targets, the scene, the G-buffer, the bloom chain and the
+// overdraw and outline scratch, are transient and share the graph's pool.
+RenderGraph renderGraph;
+int windowResource;
+int hiZResource;
+int drawCommandResource;
+int shadowMapResource;
+int pointShadowResource;
+int lightTileResource;
+bool showRenderGraph = false;
+const int benchmarkLightCounts[] = { 1, 16, 64, 256, 1024 };
+const int BENCHMARK_STEP_COUNT = sizeof(benchmarkLightCounts) / sizeof(benchmarkLightCounts[0]);
+const int BENCHMARK_WARMUP_FRAMES = 8; // the timer reads spans back a few frames late
+const int BENCHMARK_FRAMES = 64;
+int benchmarkStep = -1; // light count index * SHADING_PATH_COUNT + path, -1 when not running
+int benchmarkFrame = 0;
+float benchmarkSum = 0.0f;
+float benchmarkResults[BENCHMARK_STEP_COUNT][SHADING_PATH_COUNT]; // ms
+bool benchmarkDone = false;
+int benchmarkSavedPath = SHADING_FORWARD;
+int benchmarkSavedLights = 0;
 
 // --------------------------------------------------------
 // Rigidbody Objects
+PhysicsWorld physicsWorld;
+
 vector<Rigidbody> bouncingObjects;
 vector<Rigidbody*> physicsObjects;
 
 Rigidbody* ridingCube = nullptr;
 
+// Picking
+OutlinePass outlinePass(glm::vec3(0.5294117647f, 0.1019607843f, 0.7411764706f), 3);
+Rigidbody* selectedObject = nullptr;
+bool pickRequested = false;
+double pickX = 0.0;
+double pickY = 0.0;
+float pickTime = 0.0f;
+
 // --------------------------------------------------------
 // Cube Settings
 bool showOutline = false;
@@ -93,8 +215,28 @@ float cubeSpeed = 15.0f;
 // Light Settings
 glm::vec3 lightPos;
 float lightOrbitRadius = 10.0f;
+bool orbitLamp = true; // a still lamp reuses its shadow cube
+
+// Sky ambient, the skybox projected onto spherical harmonics once at startup
+SphericalHarmonics skyIrradiance;
+bool skyAmbient = true;
+float skyAmbientIntensity = 1.0f;
+float skyProjectionTime = 0.0f; // ms
+
+int main(int argc, char** argv) {
+	for (int i = 1; i + 1 < argc; i += 2) {
+		if (std::strcmp(argv[i], "--record") == 0)
+			recordPath = argv[i + 1];
+		else if (std::strcmp(argv[i], "--replay") == 0)
+			replayPath = argv[i + 1];
+		else if (std::strcmp(argv[i], "--step") == 0)
+			replayStep = static_cast<float>(std::atof(argv[i + 1]));
+		else if (std::strcmp(argv[i], "--histogram") == 0)
+			histogramPath = argv[i + 1];
+		else
+			std::cout << "ERROR::MAIN::UNKNOWN_ARGUMENT " << argv[i] << std::endl;
+	}
 
-int main() {
 	glfwInit();
 	
 	// -----------------------------------------------
@@ -104,6 +246,11 @@ int main() {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
+	// Depth and stencil bits, stated so the window matches the DEPTH24_STENCIL8 the scene
+	// target and TiledLightCuller use, blits between them need matching formats
+	glfwWindowHint(GLFW_DEPTH_BITS, 24);
+	glfwWindowHint(GLFW_STENCIL_BITS, 8);
+
 	// Forward Compatibility, for macOS
 	// glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE); 
 
@@ -126,9 +273,7 @@ int main() {
 
 	// -----------------------------------------------
 	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback); // resizing
-	glfwSetCursorPosCallback(window, mouse_callback); // mouse movement
-	glfwSetMouseButtonCallback(window, mouse_button_callback); // mouse clicks
-	glfwSetScrollCallback(window, scroll_callback); // scrolling
+	Input::Init(window, mouse_callback, mouse_button_callback, scroll_callback); // keys, mouse movement, clicks and scrolling
 
 	glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED); // hidden cursor
 
@@ -194,17 +339,17 @@ int main() {
 		ambient, diffuseFlashlight, glm::vec3(1.0f, 1.0f, 1.0f),
 		camera.Position, camera.Front);
 
-	pointLights[0] = PointLight(0, 1.0f, ambient, diffuseLamp, glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f));
+	pointLights[0] = PointLight(0, lampRange, ambient, diffuseLamp, glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f));
 
 	// --------------------------------
 	// texture
-	unsigned int boxDiffuseMap = loadTexture("assets/textures/container2.png");
+	unsigned int boxDiffuseMap = loadTexture("assets/textures/container2.png", true);
 	unsigned int boxSpecularMap = loadTexture("assets/textures/container2_specular.png");
-	unsigned int boxEmissionMap = loadTexture("assets/textures/container2_emission.jpg");
+	unsigned int boxEmissionMap = loadTexture("assets/textures/container2_emission.jpg", true);
 
-	unsigned int boardsDiffuseMap = loadTexture("assets/textures/boards.png");
+	unsigned int boardsDiffuseMap = loadTexture("assets/textures/boards.png", true);
 	unsigned int boardsSpecularMap = loadTexture("assets/textures/boards_specular.png");
-	unsigned int boardsEmissionMap = loadTexture("assets/textures/boards_emission.jpg");
+	unsigned int boardsEmissionMap = loadTexture("assets/textures/boards_emission.jpg", true);
 
 	vector<string> faces
 	{
@@ -216,19 +361,52 @@ int main() {
 		"assets/textures/skybox/back.png"
 	};
 	unsigned int skycubeTexture = loadCubemap(faces);
+	skybox.Init(skycubeTexture);
 
 	// ---------------------------------
 	// shaders file translation
 	litShader = Shader("assets/shaders/lit/VertexShader.vert", "assets/shaders/lit/FragmentShader.frag");
 	litTexShader = Shader("assets/shaders/lit/VertexShaderTex.vert", "assets/shaders/lit/FragmentShaderTex.frag");
+	litIndirectShader = Shader("assets/shaders/lit/VertexShaderIndirect.vert", "assets/shaders/lit/FragmentShader.frag");
+	litTexIndirectShader = Shader("assets/shaders/lit/VertexShaderIndirect.vert", "assets/shaders/lit/FragmentShaderTex.frag");
+	prepassShader = Shader("assets/shaders/depth/DepthOnly.vert", "assets/shaders/depth/DepthOnly.frag");
+	prepassIndirectShader = Shader("assets/shaders/depth/DepthOnlyIndirect.vert", "assets/shaders/depth/DepthOnly.frag");
 	lightShader = Shader("assets/shaders/lighting/VertexShader.vert", "assets/shaders/lighting/FragmentShader.frag");
 	colorShader = Shader("assets/shaders/unlit/VertexShader.vert", "assets/shaders/unlit/FragmentShader.frag");
-	skyboxShader = Shader("assets/shaders/skybox/VertexShader.vert", "assets/shaders/skybox/FragmentShader.frag");
-
-	// shader settings
-	skyboxShader.use();
 
-	skyboxShader.setInt("skybox", 0);
+	glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+	outlinePass.Init();
+	hiZBuffer.Init(framebufferWidth, framebufferHeight);
+	overdrawPass.Init();
+	shadowMap.Init();
+	pointShadowMap.Init();
+	deferredRenderer.Init();
+	tiledLightCuller.Init(framebufferWidth, framebufferHeight);
+	shadingTimer.Init();
+	hdrPipeline.Init();
+
+	windowResource = renderGraph.Import("Window");
+	hiZResource = renderGraph.Import("Hi-Z Pyramid");
+	drawCommandResource = renderGraph.Import("Draw Commands");
+	shadowMapResource = renderGraph.Import("Cascaded Shadow Map");
+	pointShadowResource = renderGraph.Import("Lamp Shadow Cube");
+	lightTileResource = renderGraph.Import("Light Tiles");
+	renderGraph.SetOutput(windowResource);
+	renderGraph.SetOutput(hiZResource); // next frame's culling reads it
+
+	// the coefficients never change, every shader that takes them gets them once
+	double projectionStart = glfwGetTime();
+	skyAmbient = projectCubemap(faces, skyIrradiance);
+	skyProjectionTime = static_cast<float>((glfwGetTime() - projectionStart) * 1000.0);
+
+	Shader* skyAmbientShaders[] = { &litShader, &litTexShader, &litIndirectShader, &litTexIndirectShader,
+		&deferredRenderer.GetDirectionalShader() };
+	for (Shader* shader : skyAmbientShaders)
+	{
+		shader->use();
+		for (int i = 0; i < SphericalHarmonics::COEFFICIENT_COUNT; i++)
+			shader->setVec3("shCoefficients[" + std::to_string(i) + "]", skyIrradiance.coefficients[i]);
+	}
 
 	// shader settings
 	litTexShader.use();
@@ -238,67 +416,85 @@ int main() {
 	litTexShader.setInt("material.emission", 2);
 	litTexShader.setFloat("material.shininess", 32.0f);
 
+	litTexIndirectShader.use();
+
+	litTexIndirectShader.setInt("material.diffuse", 0);
+	litTexIndirectShader.setInt("material.specular", 1);
+	litTexIndirectShader.setInt("material.emission", 2);
+	litTexIndirectShader.setFloat("material.shininess", 32.0f);
+
 	// lit shader
 	litShader.use();
 
-	litShader.setVec3("material.diffuse", glm::vec3(0.5f));
 	litShader.setVec3("material.emission", glm::vec3(0.0f));
 	litShader.setFloat("material.shininess", 32.0f);
 
+	litIndirectShader.use();
+
+	litIndirectShader.setVec3("material.emission", glm::vec3(0.0f));
+	litIndirectShader.setFloat("material.shininess", 32.0f);
+
 	// ---------------------------------
 	// light setup
 	dirLight.Setup(litShader, true);
 	dirLight.Setup(litTexShader, true);
+	dirLight.Setup(litIndirectShader, true);
+	dirLight.Setup(litTexIndirectShader, true);
 	dirLight.Setup(lightShader, true);
+	dirLight.Setup(deferredRenderer.GetDirectionalShader(), true);
 	for (auto it = std::begin(spotLights); it != std::end(spotLights); ++it) {
+		it->Setup(deferredRenderer.GetDirectionalShader(), true);
+		it->Setup(tiledLightCuller.GetCullShader(), true);
 		it->Setup(litShader, true);
 		it->Setup(litTexShader, true);
-		it->Setup(lightShader, true);
-	}
-	for (auto it = std::begin(pointLights); it != std::end(pointLights); ++it) {
-		it->Setup(litShader, true);
-		it->Setup(litTexShader, true);
+		it->Setup(litIndirectShader, true);
+		it->Setup(litTexIndirectShader, true);
 		it->Setup(lightShader, true);
 	}
 
 	// ---------------------------------
-	// mesh setups
-	unsigned int cubeVBO, cubeVAO;
-	cubeMeshSetupX(cubeVBO, cubeVAO, glm::vec2(1.0f));
-
-	unsigned int sphereVBO, sphereVAO, sphereEBO;
-	unsigned int sphereVerticesNum = sphereMeshSetup(sphereVBO, sphereVAO, sphereEBO, 50, 50);
+	// mesh setups, every cached mesh is also copied into the shared arena
+	geometryArena.Init(meshCache.GetFormat());
+	meshCache.SetArena(&geometryArena);
+	indirectRenderer.Init();
+
+	streamBuffer.Init(4 << 20);
+	Object3D::streamBuffer = &streamBuffer;
+	indirectRenderer.SetStreamBuffer(&streamBuffer);
+	shadowMap.SetStreamBuffer(&streamBuffer);
+	pointShadowMap.SetStreamBuffer(&streamBuffer);
+	glGenBuffers(1, &pointLightBuffer);
+
+	Mesh& cubeMesh = meshCache.GetCube();
+	Mesh& sphereMesh = meshCache.GetSphere(50, 50);
+
+	// projected diameter over screen height where each level stops being used
+	sphereLODs.AddLevel(sphereMesh, 0.25f);
+	sphereLODs.AddLevel(meshCache.GetSphere(24, 24), 0.08f);
+	sphereLODs.AddLevel(meshCache.GetSphere(12, 12), 0.025f);
+	sphereLODs.AddLevel(meshCache.GetSphere(6, 6), 0.0f);
 
 	// ----------------------------
 	// cubes
 	Object3D lightCube = Object3D(glm::vec3(0.0f, 0.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(0.05f),
-		cubeVAO,
-		lightShader,
-		36,
-		false);
+		cubeMesh,
+		lightShader);
 
-	Object3D floor = Object3D(glm::vec3(0.0f, -1.55f, 0.0f),
+	Rigidbody floor = Rigidbody(glm::vec3(0.0f, -1.55f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(1000.0f, 0.01f, 1000.00f),
-		cubeVAO,
+		cubeMesh,
 		litTexShader,
-		36,
-		false,
+		0.0f,
+		ObjectType::STATIC,
+		ShapeType::AABB,
 		boardsDiffuseMap,
 		boardsSpecularMap,
 		boardsEmissionMap,
 		glm::vec2(1000.0f));
-
-	skybox = new Object3D(glm::vec3(0.0f, 0.0f, 0.0f),
-		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
-		glm::vec3(1.0f, 1.0f, 1.0f),
-		cubeVAO,
-		skyboxShader,
-		36,
-		false,
-		skycubeTexture);
+	floor.restitution = 0.9f;
 
 	float density = 1.0f;
 	glm::vec3 sphereColor = glm::vec3(1.0f, 1.0f, 0.0f);
@@ -306,62 +502,51 @@ int main() {
 	bouncingObjects.push_back(Rigidbody(glm::vec3(-6.0f, 3.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(0.545f),
-		sphereVAO,
+		sphereMesh,
 		litShader,
-		sphereVerticesNum,
-		true,
 		4.0 / 3.0 * glm::pi<float>() * pow(0.545f, 2) * density,
-		ObjectType::DYNAMIC, 0, 0, 0, glm::vec2(0.0f), sphereColor));
+		ObjectType::DYNAMIC, ShapeType::SPHERE, 0, 0, 0, glm::vec2(0.0f), sphereColor));
 
 	bouncingObjects.push_back(Rigidbody(glm::vec3(-6.0f, 7.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(0.545f),
-		sphereVAO,
+		sphereMesh,
 		litShader,
-		sphereVerticesNum,
-		true,
 		4.0 / 3.0 * glm::pi<float>() * pow(0.545f, 2) * density,
-		ObjectType::DYNAMIC, 0, 0, 0, glm::vec2(0.0f), sphereColor));
+		ObjectType::DYNAMIC, ShapeType::SPHERE, 0, 0, 0, glm::vec2(0.0f), sphereColor));
 
 	bouncingObjects.push_back(Rigidbody(glm::vec3(-6.0f, 10.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(0.545f),
-		sphereVAO,
+		sphereMesh,
 		litShader,
-		sphereVerticesNum,
-		true,
 		4.0 / 3.0 * glm::pi<float>() * pow(0.545f, 2) * density,
-		ObjectType::DYNAMIC, 0, 0, 0, glm::vec2(0.0f), sphereColor));
+		ObjectType::DYNAMIC, ShapeType::SPHERE, 0, 0, 0, glm::vec2(0.0f), sphereColor));
 
 	bouncingObjects.push_back(Rigidbody(glm::vec3(-6.0f, 1.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(0.545f),
-		sphereVAO,
+		sphereMesh,
 		litShader,
-		sphereVerticesNum,
-		true,
 		4.0 / 3.0 * glm::pi<float>() * pow(0.545f, 2) * density,
-		ObjectType::DYNAMIC, 0, 0, 0, glm::vec2(0.0f), sphereColor));
+		ObjectType::DYNAMIC, ShapeType::SPHERE, 0, 0, 0, glm::vec2(0.0f), sphereColor));
 
 	bouncingObjects.push_back(Rigidbody(glm::vec3(-10.0f, 4.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(0.545f),
-		sphereVAO,
+		sphereMesh,
 		litShader,
-		sphereVerticesNum,
-		true,
 		4.0 / 3.0 * glm::pi<float>() * pow(0.545f, 2) * density,
-		ObjectType::DYNAMIC, 0, 0, 0, glm::vec2(0.0f), sphereColor));
+		ObjectType::DYNAMIC, ShapeType::SPHERE, 0, 0, 0, glm::vec2(0.0f), sphereColor));
 
 	bouncingObjects.push_back(Rigidbody(glm::vec3(6.0f, 4.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f),
-		cubeVAO,
+		cubeMesh,
 		litTexShader,
-		36,
-		false,
 		1.0f * density,
 		ObjectType::DYNAMIC,
+		ShapeType::AABB,
 		boxDiffuseMap,
 		boxSpecularMap,
 		boxEmissionMap));
@@ -369,12 +554,11 @@ int main() {
 	bouncingObjects.push_back(Rigidbody(glm::vec3(10.0f, 6.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f),
-		cubeVAO,
+		cubeMesh,
 		litTexShader,
-		36,
-		false,
 		1.0f * density,
 		ObjectType::DYNAMIC,
+		ShapeType::AABB,
 		boxDiffuseMap,
 		boxSpecularMap,
 		boxEmissionMap));
@@ -382,12 +566,11 @@ int main() {
 	Rigidbody fallingCube = Rigidbody(glm::vec3(2.0f, 2.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f),
-		cubeVAO,
+		cubeMesh,
 		litTexShader,
-		36,
-		false,
 		1.0f * density,
 		ObjectType::DYNAMIC,
+		ShapeType::AABB,
 		boxDiffuseMap,
 		boxSpecularMap,
 		boxEmissionMap);
@@ -395,12 +578,11 @@ int main() {
 	ridingCube = new Rigidbody(glm::vec3(0.0f, -1.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(1.0f, 1.0f, 1.0f),
-		cubeVAO,
+		cubeMesh,
 		litTexShader,
-		36,
-		false,
 		1.0f * density,
 		ObjectType::KINEMATIC,
+		ShapeType::AABB,
 		boxDiffuseMap,
 		boxSpecularMap,
 		boxEmissionMap);
@@ -408,12 +590,10 @@ int main() {
 	Rigidbody fallingSphere = Rigidbody(glm::vec3(-2.0f, 2.0f, 0.0f),
 		glm::vec3(glm::radians(0.0f), glm::radians(0.0f), glm::radians(0.0f)),
 		glm::vec3(0.545f),
-		sphereVAO,
+		sphereMesh,
 		litShader,
-		sphereVerticesNum,
-		true,
 		4.0 / 3.0 * glm::pi<float>() * pow(0.545f, 2) * density,
-		ObjectType::DYNAMIC, 0, 0, 0, glm::vec2(0.0f), sphereColor);
+		ObjectType::DYNAMIC, ShapeType::SPHERE, 0, 0, 0, glm::vec2(0.0f), sphereColor);
 
 	// Physics Objects
 	for (unsigned int i = 0; i < bouncingObjects.size(); i++)
@@ -424,11 +604,17 @@ int main() {
 	physicsObjects.push_back(&fallingCube);
 	physicsObjects.push_back(&fallingSphere);
 	physicsObjects.push_back(ridingCube);
+	selectedObject = ridingCube;
+
+	for (Rigidbody* body : physicsObjects)
+	{
+		physicsWorld.Add(body);
+	}
+	physicsWorld.Add(&floor);
+	physicsWorld.onCollision = resolveSpecialCollision;
 
 	glEnable(GL_DEPTH_TEST);
 	glDepthFunc(GL_LEQUAL);
-	
-	glEnable(GL_STENCIL_TEST);
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -445,36 +631,52 @@ int main() {
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
 	ImGui_ImplOpenGL3_Init("#version 130");
 
+	// recording and replays start on the first frame, from the scene as it was built
+	if (replayPath != nullptr && loadInputStream(replayPath, recordedInput)) {
+		Input::StartPlayback(recordedInput, replayStep);
+		replayRun = Input::IsPlaying();
+	}
+	else if (recordPath != nullptr) {
+		Input::StartRecording();
+	}
+
 	// --------------------------------------------------------------------------
 	while (!glfwWindowShouldClose(window))
 	{
-		Input::Process(window);
-
-		ImGui_ImplOpenGL3_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
-		ImGui::NewFrame();
-
-		// settings
+		// settings, frameTime is how long the last frame took, replays step by the stream
 		float currentFrame = glfwGetTime();
-		deltaTime = currentFrame - lastFrame;
+		float frameTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
+		// the first replayed frame also paid for loading
+		if (replayRun && Input::GetPlaybackFrame() > 0)
+			replayFrameTimes.push_back(frameTime * 1000.0f);
 
-		// background color
-		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-		
-		glEnable(GL_DEPTH_TEST);
-		glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+		// bindings read deltaTime while Process runs them
+		deltaTime = Input::GetDeltaTime(frameTime);
+		Input::Process(deltaTime);
+		simulationTime += deltaTime;
 
+		if (replayRun && !Input::IsPlaying()) {
+			replayRun = false;
+			reportReplay();
+			glfwSetWindowShouldClose(window, true);
+		}
+
+		// blocks only if the GPU is still three frames behind
+		streamBuffer.BeginFrame();
+
+		updateLightBenchmark();
+
+		ImGui_ImplOpenGL3_NewFrame();
+		ImGui_ImplGlfw_NewFrame();
+		ImGui::NewFrame();
 
 		// matrices
 		glm::mat4 model;
 		glm::mat4 view = camera.GetViewMatrix();
 		glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
 
-		glStencilMask(0x00);
-
 		// light and shaders
 		lightShader.use();
 		lightShader.setMat4("view", view);
@@ -491,15 +693,21 @@ int main() {
 		litShader.setMat4("projection", projection);
 		litShader.setVec3("viewPos", camera.Position);
 
+		litTexIndirectShader.use();
+		litTexIndirectShader.setMat4("view", view);
+		litTexIndirectShader.setMat4("projection", projection);
+		litTexIndirectShader.setVec3("viewPos", camera.Position);
+
+		litIndirectShader.use();
+		litIndirectShader.setMat4("view", view);
+		litIndirectShader.setMat4("projection", projection);
+		litIndirectShader.setVec3("viewPos", camera.Position);
+
 		colorShader.use();
 		colorShader.setMat4("view", view);
 		colorShader.setMat4("projection", projection);
 		colorShader.setVec3("viewPos", camera.Position);
 
-		skyboxShader.use();
-		skyboxShader.setMat4("view", view);
-		skyboxShader.setMat4("projection", projection);
-
 		spotLights[0].position = camera.Position;
 		spotLights[0].direction = camera.Front;
 
@@ -508,97 +716,417 @@ int main() {
 		vector<Shader> shaders;
 		shaders.push_back(litShader);
 		shaders.push_back(litTexShader);
+		shaders.push_back(litIndirectShader);
+		shaders.push_back(litTexIndirectShader);
 		shaders.push_back(lightShader);
+		shaders.push_back(deferredRenderer.GetDirectionalShader());
+		shaders.push_back(tiledLightCuller.GetCullShader());
 
 		int j = 0;
 		for (auto it = std::begin(spotLights); it != std::end(spotLights); ++it, j++) {	
 			it->Update(shaders, true, j);
 		}
-		j = 0;
-		for (auto it = std::begin(pointLights); it != std::end(pointLights); ++it, j++) {
-			it->Update(litShader, true, j);
-			it->Update(litTexShader, true, j);
-			it->Update(lightShader, true, j);
-		}
-
-		// skybox 
-		glDepthMask(GL_FALSE);
-		glDisable(GL_STENCIL_TEST);
-		glDisable(GL_BLEND);
-		glCullFace(GL_FRONT);
-
-		skybox->Draw(GL_TEXTURE_CUBE_MAP);
-
-		glCullFace(GL_BACK);
-		glEnable(GL_BLEND);
-		glEnable(GL_STENCIL_TEST);
-		glDepthMask(GL_TRUE);
-
-		// floor
-		floor.Draw();
 
 		// light cube
-		float lightX = sin(glfwGetTime()) * lightOrbitRadius;
-		float lightZ = cos(glfwGetTime()) * lightOrbitRadius;
-		lightPos = glm::vec3(lightX, 0.0f, lightZ);
+		if (orbitLamp)
+		{
+			float lightX = static_cast<float>(sin(simulationTime)) * lightOrbitRadius;
+			float lightZ = static_cast<float>(cos(simulationTime)) * lightOrbitRadius;
+			lightPos = glm::vec3(lightX, 0.0f, lightZ);
+		}
 
 		lightCube.SetPosition(lightPos);
 
-		lightCube.Draw();
+		// General Physics
+		if (!pause)
+			physicsWorld.Step(deltaTime);
+
+		// Picking, static bodies block the ray but can't be selected
+		if (pickRequested) {
+			pickRequested = false;
+
+			int windowWidth, windowHeight;
+			glfwGetWindowSize(window, &windowWidth, &windowHeight);
+
+			double pickStart = glfwGetTime();
+			glm::vec3 rayDirection = camera.ScreenPointToRay(static_cast<float>(pickX), static_cast<float>(pickY),
+				static_cast<float>(windowWidth), static_cast<float>(windowHeight), projection);
+
+			RaycastHit hit;
+			if (physicsWorld.Raycast(camera.Position, rayDirection, 100.0f, hit) && hit.body->behavior != ObjectType::STATIC)
+				selectedObject = hit.body;
+			else
+				selectedObject = nullptr;
+			pickTime = static_cast<float>((glfwGetTime() - pickStart) * 1000.0);
+		}
 
-		// Bouncing Objects
-	
-		for (unsigned int i = 0; i < bouncingObjects.size(); i++) {
-			if (bouncingObjects[i].GetPosition().y <= -1.0f) {
-				if (bouncingObjects[i].GetPosition().y < 0)
-					bouncingObjects[i].velocity.y *= -0.9f;
-
-				if (bouncingObjects[i].velocity.y < 0.001f) {
-					bouncingObjects[i].velocity.y = 0.0f;
-					bouncingObjects[i].SetRotation(bouncingObjects[i].GetRotation().x, bouncingObjects[i].GetRotation().y, 0.0f);
-				}
+		// boxes are the occluders, rasterized on the CPU before anything is tested against them
+		cpuOccludedCount = 0;
+		if (occlusionMode == OCCLUSION_CPU)
+		{
+			softwareOcclusion.Begin(projection * view);
+			softwareOcclusion.AddBox(std::get<AABBShape>(floor.shape).min(), std::get<AABBShape>(floor.shape).max());
+			for (Rigidbody* object : physicsObjects)
+			{
+				if (const AABBShape* box = std::get_if<AABBShape>(&object->shape))
+					softwareOcclusion.AddBox(box->min(), box->max());
 			}
+			softwareOcclusion.End();
 		}
 
-		// Resetting Cube and Sphere
-		if (fallingCube.GetPosition().y <= -3.0f) {
-			fallingCube.SetPosition(fallingCube.GetPosition().x, 10.0f + random(5.0f), fallingCube.GetPosition().z);
-			fallingCube.velocity = glm::vec3(0.0f);
+		// every lit object only gets the point lights whose range reaches its bounds
+		lightSpheres.clear();
+		pointLightData.clear();
+		for (PointLight& light : pointLights)
+		{
+			pointLightData.push_back(light.GetData());
+			lightSpheres.push_back(pointLightData.back().position);
 		}
-
-		if (fallingSphere.GetPosition().y <= -3.0f) {
-			fallingSphere.SetPosition(fallingSphere.GetPosition().x, 10.0f + random(5.0f), fallingSphere.GetPosition().z);
-			fallingSphere.velocity = glm::vec3(0.0f);
+		unsigned int pointLightBytes = static_cast<unsigned int>(pointLightData.size() * sizeof(PointLightData));
+		if (streamBuffer.BindStorage(POINT_LIGHT_BINDING, pointLightData.data(), pointLightBytes) < 0)
+		{
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, pointLightBuffer);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, pointLightBytes, pointLightData.data(), GL_STREAM_DRAW);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, POINT_LIGHT_BINDING, pointLightBuffer);
 		}
 
-		// General Physics
+		floor.lights = selectLights(lightSpheres, floor.GetBounds());
+		for (Rigidbody* object : physicsObjects)
+			object->lights = selectLights(lightSpheres, object->GetBounds());
 
+		lightAssignmentCount = 0;
+		for (int i = 0; i < MAX_OBJECT_LIGHTS; i++)
+		{
+			lightAssignmentCount += floor.lights[i] >= 0;
+			for (Rigidbody* object : physicsObjects)
+				lightAssignmentCount += object->lights[i] >= 0;
+		}
+
+		sphereLODs.Clear();
+		indirectRenderer.Clear();
+		opaqueObjects.clear();
+		opaqueObjects.push_back(&floor);
 		for (unsigned int i = 0; i < physicsObjects.size(); i++)
 		{
-			if (!pause) {
-				if (physicsObjects[i]->behavior == ObjectType::DYNAMIC)
-					physicsObjects[i]->ApplyForce(glm::vec3(0.0f, -0.0098f, 0.0f));
-				
-				for (unsigned int j = i + 1; j < physicsObjects.size(); j++)
+			Rigidbody* object = physicsObjects[i];
+			bool isSphere = std::holds_alternative<SphereShape>(object->shape);
+
+			if (occlusionMode == OCCLUSION_CPU && object->mesh != nullptr)
+			{
+				glm::vec4 bounds = object->GetBounds();
+				if (softwareOcclusion.IsOccluded(glm::vec3(bounds), bounds.w))
 				{
-					CollisionInfo info = checkCollisions(*physicsObjects[i], *physicsObjects[j]);
+					cpuOccludedCount++;
+					continue;
+				}
+			}
 
-					if (info.collided) {
-						resolveCollision(*physicsObjects[i], *physicsObjects[j], info);
-					}
+			// lit objects whose mesh sits in the arena go out in one multi-draw per material
+			Shader* indirectShader = nullptr;
+			if (&object->shader == &litShader)
+				indirectShader = &litIndirectShader;
+			else if (&object->shader == &litTexShader)
+				indirectShader = &litTexIndirectShader;
+
+			if (useIndirect && indirectShader != nullptr && object->mesh != nullptr)
+			{
+				Mesh& mesh = useLOD && isSphere ? sphereLODs.Select(object, camera.Position, glm::radians(camera.Zoom)) : *object->mesh;
+				if (indirectRenderer.Add(*object, mesh, *indirectShader))
+				{
+					if (useLOD && isSphere)
+						sphereLODs.Count(object);
+					continue;
 				}
+			}
 
-				physicsObjects[i]->PhysicsProcess(deltaTime);
+			if (useLOD && isSphere)
+				sphereLODs.Submit(object, camera.Position, glm::radians(camera.Zoom));
+			else
+				opaqueObjects.push_back(object);
+		}
+
+		// every body casts, the shadow maps cull them per cascade and per face
+		shadowCasters.clear();
+		shadowCasters.push_back(&floor);
+		shadowCasters.insert(shadowCasters.end(), physicsObjects.begin(), physicsObjects.end());
+
+		// The deferred path runs the same lit shaders into the G-buffer instead of shading,
+		// forward+ runs them over the lights of their tile. The overdraw view always counts
+		// the forward passes.
+		bool deferredFrame = shadingPath == SHADING_DEFERRED && !showOverdraw;
+		bool tiledFrame = shadingPath == SHADING_FORWARD_PLUS && !showOverdraw;
+		// forward+ bounds its tiles with the pre-pass depth, it can't go without
+		bool prepassFrame = depthPrepass || tiledFrame;
+		bool gpuOcclusion = occlusionMode == OCCLUSION_GPU;
+
+		// ---------------------------------------------------------------------
+		// Frame graph, passes run at Execute in the order they're added here
+		renderGraph.Reset();
+		int sceneResource = renderGraph.CreateTarget("HDR Scene", framebufferWidth, framebufferHeight, GL_RGBA16F, true);
+
+		auto bindScene = [&] {
+			const RenderTarget& scene = renderGraph.GetTarget(sceneResource);
+			glBindFramebuffer(GL_FRAMEBUFFER, scene.FBO);
+			glViewport(0, 0, scene.width, scene.height);
+		};
+
+		// With the pre-pass every pixel's depth is final before shading, so the lit
+		// shaders run once per pixel with GL_EQUAL instead of once per overlapping layer
+		GLint depthFunc;
+		glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+
+		auto drawPrepass = [&] {
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			drawOpaqueGeometry(prepassShader, prepassIndirectShader, view, projection);
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		};
+		auto drawShaded = [&](bool equalDepth) {
+			if (equalDepth)
+			{
+				glDepthFunc(GL_EQUAL);
+				glDepthMask(GL_FALSE);
 			}
 
-			if (showOutline && physicsObjects[i] == ridingCube) {
-				DrawWithOutline(*ridingCube, colorShader, glm::vec3(0.5294117647f, 0.1019607843f, 0.7411764706f));
+			overdrawPass.BeginQuery();
+			if (showOverdraw)
+			{
+				drawOpaqueGeometry(overdrawPass.GetCountShader(), overdrawPass.GetCountIndirectShader(), view, projection);
 			}
-			else {
-				physicsObjects[i]->Draw();
+			else
+			{
+				for (Object3D* object : opaqueObjects)
+					object->Draw();
+				sphereLODs.Draw();
+				indirectRenderer.Draw(geometryArena);
+			}
+			overdrawPass.EndQuery();
+
+			glDepthFunc(depthFunc);
+			glDepthMask(GL_TRUE);
+		};
+		// the shadow maps are only fit once their passes ran
+		auto applyShading = [&] {
+			Shader* shadowedShaders[] = { &litShader, &litTexShader, &litIndirectShader, &litTexIndirectShader,
+				&deferredRenderer.GetDirectionalShader(), &deferredRenderer.GetPointShader() };
+			for (Shader* shader : shadowedShaders)
+			{
+				shader->use();
+				shadowMap.Apply(*shader, 3);
+				pointShadowMap.Apply(*shader, 4, 0);
+				shader->setBool("gBufferPass", deferredFrame);
+				shader->setBool("tiledLights", tiledFrame);
+				shader->setBool("skyAmbient", skyAmbient);
+				shader->setFloat("skyAmbientIntensity", skyAmbientIntensity);
+				tiledLightCuller.Apply(*shader);
+			}
+		};
+
+		int pass = renderGraph.AddPass("Cull Draws", [&] {
+			indirectRenderer.Prepare(projection * view, gpuOcclusion ? &hiZBuffer : nullptr);
+		});
+		if (gpuOcclusion)
+			renderGraph.Read(pass, hiZResource, RenderGraph::ACCESS_SAMPLED);
+		renderGraph.Write(pass, drawCommandResource, RenderGraph::ACCESS_STORAGE);
+
+		pass = renderGraph.AddPass("Cascaded Shadows", [&] {
+			shadowMap.resolution = shadowResolutions[shadowResolution];
+			shadowMap.Render(dirLight, view, glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f, shadowCasters);
+		});
+		renderGraph.Write(pass, shadowMapResource, RenderGraph::ACCESS_ATTACHMENT);
+
+		pass = renderGraph.AddPass("Lamp Shadow", [&] {
+			pointShadowMap.Render(pointLights[0], shadowCasters);
+		});
+		renderGraph.Write(pass, pointShadowResource, RenderGraph::ACCESS_ATTACHMENT);
+
+		pass = renderGraph.AddPass("Clear", [&] {
+			bindScene();
+			glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+			glEnable(GL_DEPTH_TEST);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		});
+		renderGraph.Write(pass, sceneResource, RenderGraph::ACCESS_ATTACHMENT);
+
+		if (showOverdraw)
+		{
+			int countResource = renderGraph.CreateTarget("Overdraw Counts", framebufferWidth, framebufferHeight,
+				OverdrawPass::COUNT_FORMAT, true);
+			pass = renderGraph.AddPass("Overdraw", [&, countResource] {
+				bindScene();
+				shadingTimer.Begin();
+				overdrawPass.Begin(renderGraph.GetTarget(countResource));
+				if (depthPrepass)
+					drawPrepass();
+				drawShaded(depthPrepass);
+				overdrawPass.End();
+				shadingTimer.End();
+			});
+			renderGraph.Read(pass, drawCommandResource, RenderGraph::ACCESS_INDIRECT);
+			renderGraph.Write(pass, countResource, RenderGraph::ACCESS_ATTACHMENT);
+			renderGraph.Write(pass, sceneResource, RenderGraph::ACCESS_ATTACHMENT);
+		}
+		else if (deferredFrame)
+		{
+			int albedoResource = renderGraph.CreateTarget("G-Buffer Albedo", framebufferWidth, framebufferHeight,
+				DeferredRenderer::ALBEDO_FORMAT, true);
+			int normalResource = renderGraph.CreateTarget("G-Buffer Normal", framebufferWidth, framebufferHeight,
+				DeferredRenderer::NORMAL_FORMAT, false);
+			pass = renderGraph.AddPass("G-Buffer", [&, albedoResource, normalResource] {
+				bindScene();
+				applyShading();
+				shadingTimer.Begin();
+				deferredRenderer.BeginGeometry(renderGraph.GetTarget(albedoResource), renderGraph.GetTarget(normalResource));
+				if (depthPrepass)
+					drawPrepass();
+				drawShaded(depthPrepass);
+				deferredRenderer.EndGeometry();
+			});
+			renderGraph.Read(pass, drawCommandResource, RenderGraph::ACCESS_INDIRECT);
+			renderGraph.Write(pass, albedoResource, RenderGraph::ACCESS_ATTACHMENT);
+			renderGraph.Write(pass, normalResource, RenderGraph::ACCESS_ATTACHMENT);
+
+			pass = renderGraph.AddPass("Deferred Lighting", [&] {
+				bindScene();
+				deferredRenderer.Light(view, projection, static_cast<unsigned int>(pointLightData.size()));
+				shadingTimer.End();
+			});
+			renderGraph.Read(pass, albedoResource, RenderGraph::ACCESS_SAMPLED);
+			renderGraph.Read(pass, normalResource, RenderGraph::ACCESS_SAMPLED);
+			renderGraph.Read(pass, shadowMapResource, RenderGraph::ACCESS_SAMPLED);
+			renderGraph.Read(pass, pointShadowResource, RenderGraph::ACCESS_SAMPLED);
+			renderGraph.Write(pass, sceneResource, RenderGraph::ACCESS_ATTACHMENT);
+		}
+		else
+		{
+			if (prepassFrame)
+			{
+				pass = renderGraph.AddPass("Depth Pre-pass", [&] {
+					bindScene();
+					shadingTimer.Begin();
+					drawPrepass();
+				});
+				renderGraph.Read(pass, drawCommandResource, RenderGraph::ACCESS_INDIRECT);
+				renderGraph.Write(pass, sceneResource, RenderGraph::ACCESS_ATTACHMENT);
+			}
+
+			if (tiledFrame)
+			{
+				pass = renderGraph.AddPass("Light Tiles", [&] {
+					tiledLightCuller.Cull(renderGraph.GetTarget(sceneResource), view, projection,
+						static_cast<unsigned int>(pointLightData.size()));
+				});
+				renderGraph.Read(pass, sceneResource, RenderGraph::ACCESS_SAMPLED);
+				renderGraph.Write(pass, lightTileResource, RenderGraph::ACCESS_STORAGE);
 			}
+
+			pass = renderGraph.AddPass("Opaque", [&] {
+				bindScene();
+				applyShading();
+				if (!prepassFrame)
+					shadingTimer.Begin();
+				drawShaded(prepassFrame);
+				shadingTimer.End();
+			});
+			renderGraph.Read(pass, drawCommandResource, RenderGraph::ACCESS_INDIRECT);
+			renderGraph.Read(pass, shadowMapResource, RenderGraph::ACCESS_SAMPLED);
+			renderGraph.Read(pass, pointShadowResource, RenderGraph::ACCESS_SAMPLED);
+			if (tiledFrame)
+				renderGraph.Read(pass, lightTileResource, RenderGraph::ACCESS_STORAGE);
+			renderGraph.Write(pass, sceneResource, RenderGraph::ACCESS_ATTACHMENT);
+		}
+
+		// unlit, drawn forward on every path
+		if (!showOverdraw)
+		{
+			pass = renderGraph.AddPass("Light Cube", [&] {
+				bindScene();
+				lightCube.Draw();
+			});
+			renderGraph.Write(pass, sceneResource, RenderGraph::ACCESS_ATTACHMENT);
+
+			// last, only where the depth is still cleared
+			pass = renderGraph.AddPass("Skybox", [&] {
+				bindScene();
+				skybox.Draw(view, projection);
+			});
+			renderGraph.Write(pass, sceneResource, RenderGraph::ACCESS_ATTACHMENT);
 		}
 
+		if (tiledFrame && showLightTiles)
+		{
+			pass = renderGraph.AddPass("Light Tile Heatmap", [&] {
+				bindScene();
+				tiledLightCuller.DrawHeatmap();
+			});
+			renderGraph.Read(pass, lightTileResource, RenderGraph::ACCESS_STORAGE);
+			renderGraph.Write(pass, sceneResource, RenderGraph::ACCESS_ATTACHMENT);
+		}
+
+		// occluder depth for next frame's culling, the pyramid lags a frame behind
+		if (gpuOcclusion)
+		{
+			pass = renderGraph.AddPass("Hi-Z", [&] {
+				hiZBuffer.BeginDepthPass(view, projection);
+				hiZBuffer.AddOccluder(&floor);
+				for (Rigidbody* object : physicsObjects)
+				{
+					if (std::holds_alternative<AABBShape>(object->shape))
+						hiZBuffer.AddOccluder(object);
+				}
+				hiZBuffer.EndDepthPass();
+			});
+			renderGraph.Write(pass, hiZResource, RenderGraph::ACCESS_IMAGE);
+		}
+
+		int bloomWidths[HDRPipeline::MAX_BLOOM_LEVELS];
+		int bloomHeights[HDRPipeline::MAX_BLOOM_LEVELS];
+		int bloomResources[HDRPipeline::MAX_BLOOM_LEVELS];
+		int bloomCount = hdrPipeline.GetBloomLevels(framebufferWidth, framebufferHeight, bloomWidths, bloomHeights);
+		for (int i = 0; i < bloomCount; i++)
+			bloomResources[i] = renderGraph.CreateTarget("Bloom", bloomWidths[i], bloomHeights[i], HDRPipeline::BLOOM_FORMAT, false);
+
+		if (bloomCount > 0)
+		{
+			pass = renderGraph.AddPass("Bloom", [&] {
+				RenderTarget levels[HDRPipeline::MAX_BLOOM_LEVELS];
+				for (int i = 0; i < bloomCount; i++)
+					levels[i] = renderGraph.GetTarget(bloomResources[i]);
+				hdrPipeline.RenderBloom(renderGraph.GetTarget(sceneResource), levels, bloomCount);
+			});
+			renderGraph.Read(pass, sceneResource, RenderGraph::ACCESS_SAMPLED);
+			for (int i = 0; i < bloomCount; i++)
+				renderGraph.Write(pass, bloomResources[i], RenderGraph::ACCESS_ATTACHMENT);
+		}
+
+		// back to the window in LDR, outlines and the UI are drawn after
+		pass = renderGraph.AddPass("Tonemap", [&] {
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, framebufferWidth, framebufferHeight);
+			hdrPipeline.Resolve(renderGraph.GetTarget(sceneResource),
+				bloomCount > 0 ? &renderGraph.GetTarget(bloomResources[0]) : nullptr, deltaTime);
+		});
+		renderGraph.Read(pass, sceneResource, RenderGraph::ACCESS_SAMPLED);
+		if (bloomCount > 0)
+			renderGraph.Read(pass, bloomResources[0], RenderGraph::ACCESS_SAMPLED);
+		renderGraph.Write(pass, windowResource, RenderGraph::ACCESS_ATTACHMENT);
+
+		// outlines for everything selected, in one fullscreen pass
+		outlinePass.Clear();
+		if (showOutline && selectedObject)
+		{
+			outlinePass.Add(selectedObject);
+			int maskResource = renderGraph.CreateTarget("Outline Mask", framebufferWidth, framebufferHeight,
+				OutlinePass::MASK_FORMAT, false);
+			pass = renderGraph.AddPass("Outline", [&, maskResource] {
+				outlinePass.Draw(renderGraph.GetTarget(maskResource), view, projection);
+			});
+			renderGraph.Write(pass, maskResource, RenderGraph::ACCESS_ATTACHMENT);
+			renderGraph.Write(pass, windowResource, RenderGraph::ACCESS_ATTACHMENT);
+		}
+
+		renderGraph.Compile();
+		renderGraph.Execute();
+
 		{
 			static float f = 0.0f;
 			static int counter = 0;
@@ -606,9 +1134,94 @@ int main() {
 			ImGui::Begin("Settings");
 
 			ImGui::Checkbox("Show Outline", &showOutline);
+			ImGui::SliderInt("Outline Width", &outlinePass.width, 1, 8);
 			if (ImGui::Checkbox("Lamp On", &lampOn)) {
 				spotLights[0].shown = lampOn;
 			}
+			ImGui::Checkbox("Orbit Lamp", &orbitLamp);
+			ImGui::Checkbox("Sky Ambient", &skyAmbient);
+			ImGui::SliderFloat("Sky Ambient Intensity", &skyAmbientIntensity, 0.0f, 2.0f, "%.2f");
+			ImGui::Text("Sky projected to SH in %.1f ms", skyProjectionTime);
+			if (ImGui::SliderFloat("Lamp Range", &lampRange, 1.0f, 50.0f, "%.1f"))
+				pointLights[0].UpdateRadius(lampRange);
+			ImGui::Text("Point light assignments: %u for %u objects and %u lights", lightAssignmentCount,
+				(unsigned int)physicsObjects.size() + 1, (unsigned int)lightSpheres.size());
+			if (ImGui::SliderInt("Extra Lights", &extraLightCount, 0, 1024))
+				scatterLights(extraLightCount);
+
+			ImGui::Combo("Shading", &shadingPath, shadingPathNames, IM_ARRAYSIZE(shadingPathNames));
+			ImGui::Text("Shading: %.3f ms GPU", shadingTimer.GetTime());
+			if (shadingPath == SHADING_FORWARD)
+			{
+				ImGui::Text("At most %d lights per object", MAX_OBJECT_LIGHTS);
+			}
+			else if (shadingPath == SHADING_FORWARD_PLUS)
+			{
+				ImGui::Text("Tiles: %dx%d, at most %d lights each", tiledLightCuller.GetTileCountX(), tiledLightCuller.GetTileCountY(),
+					TiledLightCuller::MAX_TILE_LIGHTS);
+				ImGui::Checkbox("Show Light Tiles", &showLightTiles);
+				ImGui::SliderFloat("Light Tile Range", &tiledLightCuller.maxCount, 1.0f, 128.0f, "%.0f");
+			}
+			else
+			{
+				ImGui::Text("Light volumes: %u", deferredRenderer.GetVolumeCount());
+			}
+			if (Input::IsRecording())
+			{
+				if (ImGui::Button("Stop Recording Input"))
+					recordedInput = Input::StopRecording();
+			}
+			else if (ImGui::Button("Record Input"))
+			{
+				Input::StartRecording();
+			}
+			ImGui::SameLine();
+			if (Input::IsPlaying())
+			{
+				if (ImGui::Button("Stop Replay"))
+					Input::StopPlayback();
+			}
+			else if (ImGui::Button("Replay Input") && recordedInput.frameCount > 0)
+			{
+				Input::StartPlayback(recordedInput);
+			}
+			ImGui::Text("Recorded input: %u events over %u frames", (unsigned int)recordedInput.events.size(), recordedInput.frameCount);
+
+			if (benchmarkStep < 0)
+			{
+				if (ImGui::Button("Run Light Benchmark"))
+					startLightBenchmark();
+			}
+			else
+			{
+				ImGui::Text("Benchmarking %d lights, %s...", benchmarkLightCounts[benchmarkStep / SHADING_PATH_COUNT],
+					shadingPathNames[benchmarkStep % SHADING_PATH_COUNT]);
+			}
+			for (int i = 0; benchmarkDone && i < BENCHMARK_STEP_COUNT; i++)
+				ImGui::Text("%4d lights: forward %.3f ms, forward+ %.3f ms, deferred %.3f ms", benchmarkLightCounts[i],
+					benchmarkResults[i][SHADING_FORWARD], benchmarkResults[i][SHADING_FORWARD_PLUS], benchmarkResults[i][SHADING_DEFERRED]);
+
+			ImGui::Checkbox("Auto Exposure", &hdrPipeline.autoExposure);
+			ImGui::SliderFloat("Exposure", &hdrPipeline.exposureCompensation, -4.0f, 4.0f, "%.1f EV");
+			ImGui::SliderFloat("Adaptation Speed", &hdrPipeline.adaptationSpeed, 0.1f, 10.0f, "%.1f");
+			ImGui::Checkbox("Bloom", &hdrPipeline.bloom);
+			ImGui::SliderFloat("Bloom Threshold", &hdrPipeline.bloomThreshold, 0.0f, 4.0f, "%.2f");
+			ImGui::SliderFloat("Bloom Intensity", &hdrPipeline.bloomIntensity, 0.0f, 0.5f, "%.3f");
+			ImGui::SliderInt("Bloom Levels", &hdrPipeline.bloomLevels, 1, HDRPipeline::MAX_BLOOM_LEVELS);
+
+			ImGui::Text("Render graph: %u passes, %u culled, %u barriers", renderGraph.GetPassCount(), renderGraph.GetCulledCount(),
+				renderGraph.GetBarrierCount());
+			ImGui::Text("Render targets: %u (%u allocations)", renderGraph.GetPool().GetTargetCount(), renderGraph.GetPool().GetAllocationCount());
+			ImGui::Checkbox("Show Render Graph", &showRenderGraph);
+			for (int i = 0; showRenderGraph && i < (int)renderGraph.GetPassCount(); i++)
+			{
+				if (renderGraph.IsCulled(i))
+					ImGui::Text("  %s (culled)", renderGraph.GetPassName(i));
+				else if (renderGraph.GetBarriers(i) != 0)
+					ImGui::Text("  %s, barrier 0x%x", renderGraph.GetPassName(i), renderGraph.GetBarriers(i));
+				else
+					ImGui::Text("  %s", renderGraph.GetPassName(i));
+			}
 
 			static int currentDepth = 0;
 			const char* depthVar[] = { "GL_LEQUAL", "GL_NOTEQUAL" };
@@ -658,6 +1271,98 @@ int main() {
 
 			ImGui::Text("Camera Front: (%.3f, %.3f, %.3f)", cameraFront.x, cameraFront.y, cameraFront.z);
 
+			ImGui::SliderFloat("CCD Threshold (radii)", &physicsWorld.ccdThreshold, 0.05f, 2.0f, "%.2f");
+			ImGui::Text("Swept bodies: %u", physicsWorld.GetCCDCount());
+
+			ImGui::Checkbox("Allow Sleeping", &physicsWorld.allowSleeping);
+			ImGui::Text("Sleeping bodies: %u / %u", physicsWorld.GetSleepingCount(), (unsigned int)physicsWorld.GetBodies().size());
+			ImGui::Text("Broadphase pairs: %u", physicsWorld.GetPairCount());
+
+			ImGui::SliderInt("Solver Iterations", &physicsWorld.velocityIterations, 1, 32);
+			ImGui::Checkbox("Warm Starting", &physicsWorld.warmStarting);
+			ImGui::Text("Contacts: %u (%u warm started)", physicsWorld.GetContactCount(), physicsWorld.GetWarmStartedCount());
+			ImGui::Text("Static BVH: %u nodes over %u bodies", physicsWorld.GetStaticTree().GetNodeCount(), physicsWorld.GetStaticTree().GetItemCount());
+			ImGui::Text("Dynamic BVH: %u nodes over %u bodies", physicsWorld.GetDynamicTree().GetNodeCount(), physicsWorld.GetDynamicTree().GetItemCount());
+			ImGui::Text("Last pick: %.4f ms", pickTime);
+
+			ImGui::Checkbox("Sphere LOD", &useLOD);
+			ImGui::SliderFloat("LOD Bias", &sphereLODs.bias, 0.25f, 4.0f, "%.2f");
+			ImGui::SliderFloat("LOD Hysteresis", &sphereLODs.hysteresis, 0.0f, 0.5f, "%.2f");
+			for (unsigned int i = 0; i < sphereLODs.GetLevelCount(); i++)
+			{
+				const LODLevel& level = sphereLODs.GetLevel(i);
+				ImGui::Text("LOD %u: %u tris, %u instances", i, level.mesh->indexCount / 3, level.instanceCount);
+			}
+			ImGui::Text("Sphere triangles submitted: %u (%u at full detail)", sphereLODs.GetTrianglesSubmitted(), sphereLODs.GetTrianglesFullDetail());
+
+			if (ImGui::BeginCombo("Vertex Format", vertexFormatName(meshCache.GetFormat())))
+			{
+				for (VertexFormat format : { VertexFormat::FLOAT, VertexFormat::PACKED, VertexFormat::QUANTIZED })
+				{
+					bool is_selected = (meshCache.GetFormat() == format);
+					if (ImGui::Selectable(vertexFormatName(format), is_selected))
+						meshCache.SetFormat(format);
+
+					if (is_selected)
+						ImGui::SetItemDefaultFocus();
+				}
+				ImGui::EndCombo();
+			}
+			ImGui::Text("Mesh memory: %u B vertices, %u B indices", meshCache.GetVertexBytes(), meshCache.GetIndexBytes());
+
+			ImGui::Checkbox("Multi-Draw Indirect", &useIndirect);
+			ImGui::Text("Indirect: %u draws in %u multi-draws", indirectRenderer.GetDrawCount(), indirectRenderer.GetBatchCount());
+			ImGui::Checkbox("GPU Culling", &indirectRenderer.gpuCulling);
+			ImGui::Text("GPU visible: %u of %u draws", indirectRenderer.GetVisibleCount(), indirectRenderer.GetDrawCount());
+
+			ImGui::Text("Stream buffer: %s, %u of %u B last frame", streamBuffer.IsPersistent() ? "persistent map" : "glBufferSubData",
+				streamBuffer.GetBytesLastFrame(), streamBuffer.GetRegionSize());
+			ImGui::Text("Fence wait: %.3f ms", streamBuffer.GetWaitTime());
+
+			ImGui::Checkbox("Shadows", &shadowMap.enabled);
+			ImGui::SliderInt("Cascades", &shadowMap.cascadeCount, 2, CascadedShadowMap::MAX_CASCADES);
+			ImGui::Combo("Shadow Resolution", &shadowResolution, shadowResolutionNames, IM_ARRAYSIZE(shadowResolutionNames));
+			ImGui::SliderFloat("Shadow Distance", &shadowMap.shadowDistance, 10.0f, 100.0f, "%.0f");
+			ImGui::SliderFloat("Split Lambda", &shadowMap.splitLambda, 0.0f, 1.0f);
+			for (int i = 0; i < shadowMap.GetCascadeCount(); i++)
+				ImGui::Text("Cascade %d: to %.1f, %u casters", i, shadowMap.GetSplit(i), shadowMap.GetCasterCount(i));
+			ImGui::Text("Shadow draws: %u", shadowMap.GetDrawCount());
+			ImGui::Checkbox("Lamp Shadows", &pointShadowMap.enabled);
+			ImGui::Text("Lamp shadow: range %.1f, %u casters, %u draws", pointShadowMap.GetFarPlane(), pointShadowMap.GetCasterCount(), pointShadowMap.GetDrawCount());
+			ImGui::Text("Lamp shadow renders: %u, reused: %u", pointShadowMap.GetRenderCount(), pointShadowMap.GetReuseCount());
+
+			ImGui::Checkbox("Depth Pre-pass", &depthPrepass);
+			ImGui::Checkbox("Show Overdraw", &showOverdraw);
+			ImGui::SliderFloat("Overdraw Range", &overdrawPass.maxCount, 1.0f, 16.0f, "%.0f");
+			ImGui::Text("Shaded fragments: %llu (%.2f per pixel)", overdrawPass.GetFragmentCount(),
+				overdrawPass.GetPixelCount() > 0 ? (double)overdrawPass.GetFragmentCount() / overdrawPass.GetPixelCount() : 0.0);
+			// drawn first the sky shaded every pixel, early-Z now leaves it the uncovered ones
+			ImGui::Text("Sky fragments: %llu of %llu (%.0f%% saved), %.3f ms GPU", skybox.GetFragmentCount(), skybox.GetPixelCount(),
+				skybox.GetPixelCount() > 0 ? 100.0 * (1.0 - (double)skybox.GetFragmentCount() / skybox.GetPixelCount()) : 0.0,
+				skybox.GetTime());
+
+			ImGui::Combo("Occlusion", &occlusionMode, occlusionModeNames, IM_ARRAYSIZE(occlusionModeNames));
+			if (occlusionMode == OCCLUSION_GPU)
+			{
+				ImGui::Text("Hi-Z: %d levels, %u occluders", hiZBuffer.GetLevelCount(), hiZBuffer.GetOccluderCount());
+				ImGui::Text("Frustum culled: %u, occluded: %u", indirectRenderer.GetFrustumCulledCount(), indirectRenderer.GetOccludedCount());
+			}
+			else if (occlusionMode == OCCLUSION_CPU)
+			{
+				ImGui::Text("Software raster: %dx%d, %u occluder triangles", softwareOcclusion.GetWidth(), softwareOcclusion.GetHeight(), softwareOcclusion.GetTriangleCount());
+				ImGui::Text("Occluded: %u", cpuOccludedCount);
+			}
+			ImGui::Text("Arena: %u meshes, %u B vertices, %u B indices", geometryArena.GetRangeCount(), geometryArena.GetVertexBytes(), geometryArena.GetIndexBytes());
+
+			// vertex shader invocations per sphere draw, from the simulated post-transform cache
+			const MeshStats& sphereStats = sphereMesh.stats;
+			ImGui::Text("Sphere: %u tris, %u -> %u vertices", sphereStats.triangleCount, sphereStats.soupVertexCount, sphereStats.vertexCount);
+			ImGui::Text("Sphere VS invocations: %u unindexed, %u indexed, %u optimized (ACMR %.2f -> %.2f)",
+				sphereStats.triangleCount * 3,
+				(unsigned int)(sphereStats.triangleCount * sphereStats.acmrGenerated),
+				(unsigned int)(sphereStats.triangleCount * sphereStats.acmrOptimized),
+				sphereStats.acmrGenerated, sphereStats.acmrOptimized);
+
 			ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
 			ImGui::End();
 		}
@@ -665,16 +1370,20 @@ int main() {
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
+		streamBuffer.EndFrame();
+
 		glfwSwapBuffers(window);
 		glfwPollEvents();
 	}
-	delete skybox;
 
-	glDeleteVertexArrays(1, &cubeVAO);
-	glDeleteBuffers(1, &cubeVBO);
-	glDeleteVertexArrays(1, &sphereVAO);
-	glDeleteBuffers(1, &sphereVBO);
-	glDeleteBuffers(1, &sphereEBO);
+	if (recordPath != nullptr) {
+		if (Input::IsRecording())
+			recordedInput = Input::StopRecording();
+		if (saveInputStream(recordPath, recordedInput))
+			std::cout << "Recorded " << recordedInput.frameCount << " frames to " << recordPath << std::endl;
+	}
+
+	meshCache.Clear();
 	glDeleteTextures(1, &boxDiffuseMap);
 	glDeleteTextures(1, &boxSpecularMap);
 	glDeleteTextures(1, &boxEmissionMap);
@@ -686,15 +1395,89 @@ int main() {
 	ImGui_ImplGlfw_Shutdown();
 	ImGui::DestroyContext();
 
+	outlinePass.Release();
+	hiZBuffer.Release();
+	overdrawPass.Release();
+	shadowMap.Release();
+	pointShadowMap.Release();
+	deferredRenderer.Release();
+	tiledLightCuller.Release();
+	shadingTimer.Release();
+	skybox.Release();
+	hdrPipeline.Release();
+	renderGraph.Release();
+	indirectRenderer.Release();
+	streamBuffer.Release();
+	glDeleteBuffers(1, &pointLightBuffer);
+	glDeleteBuffers(1, &Object3D::objectDataBuffer);
+	geometryArena.Release();
+
 	glfwDestroyWindow(window);
 	glfwTerminate();
 
 	return 0;
 }
 
+void reportReplay()
+{
+	if (replayFrameTimes.empty())
+		return;
+
+	vector<float> sorted = replayFrameTimes;
+	std::sort(sorted.begin(), sorted.end());
+
+	float sum = 0.0f;
+	for (float time : sorted)
+		sum += time;
+	auto percentile = [&sorted](float p) { return sorted[static_cast<size_t>(p * (sorted.size() - 1))]; };
+
+	std::cout << "Replayed " << sorted.size() << " frames, ms: mean " << sum / sorted.size()
+		<< ", median " << percentile(0.5f) << ", 95th " << percentile(0.95f) << ", 99th " << percentile(0.99f)
+		<< ", max " << sorted.back() << std::endl;
+
+	if (histogramPath == nullptr)
+		return;
+
+	// quarter millisecond buckets, the last one takes everything slower
+	const float BUCKET_MS = 0.25f;
+	const int BUCKET_COUNT = 200;
+	vector<unsigned int> buckets(BUCKET_COUNT);
+	for (float time : sorted)
+		buckets[std::min(static_cast<int>(time / BUCKET_MS), BUCKET_COUNT - 1)]++;
+
+	std::ofstream file(histogramPath);
+	if (!file) {
+		std::cout << "ERROR::MAIN::HISTOGRAM_NOT_WRITTEN " << histogramPath << std::endl;
+		return;
+	}
+	file << "ms,frames\n";
+	for (int i = 0; i < BUCKET_COUNT; i++)
+		file << i * BUCKET_MS << "," << buckets[i] << "\n";
+}
+
 void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 {
-	if ((button == GLFW_MOUSE_BUTTON_RIGHT || button == GLFW_MOUSE_BUTTON_LEFT) && action == GLFW_PRESS) {
+	if (action != GLFW_PRESS)
+		return;
+
+	// Left click selects, at the cursor when it's free or through the center of the screen
+	if (button == GLFW_MOUSE_BUTTON_LEFT) {
+		if (!cursorHidden && ImGui::GetIO().WantCaptureMouse)
+			return;
+
+		int windowWidth, windowHeight;
+		glfwGetWindowSize(window, &windowWidth, &windowHeight);
+
+		if (cursorHidden) {
+			pickX = windowWidth / 2.0;
+			pickY = windowHeight / 2.0;
+		}
+		else {
+			Input::GetCursorPosition(pickX, pickY);
+		}
+		pickRequested = true;
+	}
+	else if (button == GLFW_MOUSE_BUTTON_RIGHT) {
 		firstMouse = true;
 		cursorHidden = true;
 		glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
@@ -732,9 +1515,18 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
 	glViewport(0, 0, width, height);
+
+	// minimized windows report a zero-sized framebuffer, the scene target keeps its size
+	if (width > 0 && height > 0)
+	{
+		framebufferWidth = width;
+		framebufferHeight = height;
+	}
+	hiZBuffer.Resize(width, height);
+	tiledLightCuller.Resize(width, height);
 }
 
-unsigned int loadTexture(char const* path)
+unsigned int loadTexture(char const* path, bool srgb)
 {
 	unsigned int textureID;
 	glGenTextures(1, &textureID);
@@ -751,8 +1543,15 @@ unsigned int loadTexture(char const* path)
 		else if (nrComponents == 4)
 			format = GL_RGBA;
 
+		// colors are stored gamma encoded, sampling decodes them so lighting stays linear
+		GLenum internalFormat = format;
+		if (srgb && format == GL_RGB)
+			internalFormat = GL_SRGB8;
+		else if (srgb && format == GL_RGBA)
+			internalFormat = GL_SRGB8_ALPHA8;
+
 		glBindTexture(GL_TEXTURE_2D, textureID);
-		glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 		glGenerateMipmap(GL_TEXTURE_2D);
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -789,7 +1588,9 @@ unsigned int loadCubemap(vector<string> faces)
 			else if (nrChannels == 4)
 				format = GL_RGBA;
 
-			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+			// the sky is a color too, decoded to linear like the diffuse maps
+			GLenum internalFormat = format == GL_RGBA ? GL_SRGB8_ALPHA8 : format == GL_RGB ? GL_SRGB8 : format;
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
 			stbi_image_free(data);
 		}
 		else
@@ -808,375 +1609,107 @@ unsigned int loadCubemap(vector<string> faces)
 	return textureID;
 }
 
-void cubeMeshSetupX(unsigned int& cubeVBO, unsigned int& cubeVAO, glm::vec2 UV) {
-	float vertices[] = {
-		// positions          // normals           // texture coords
-		// back
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f, // Bottom Left
-		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  UV.x, UV.y, // Top Right
-		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  UV.x, 0.0f, // Bottom Right
-		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  UV.x, UV.y, // Top Right 
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f, // Bottom Left
-		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, UV.y, // Top Left
-		// front
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f, // bottom left
-		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   UV.x, 0.0f, // bottom right
-		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   UV.x, UV.y, // top right
-		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   UV.x, UV.y, // top right
-		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, UV.y, // top left
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f, // bottom left
-		// left
-		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  UV.x, 0.0f, // top right
-		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  UV.x, UV.y, // top left
-		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, UV.y, // bottom left
-		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, UV.y, // bottom left
-		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f, // bottom right
-		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  UV.x, 0.0f, // top right
-		// right
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  UV.x, 0.0f, // top right
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, UV.y, // bottom right
-		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  UV.x, UV.y, // top right
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, UV.y, // bottom right
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  UV.x, 0.0f, // top left
-		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f, // bottom left
-		 // bottom
-		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, UV.y, // top right
-		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  UV.x, UV.y, // top left
-		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  UV.x, 0.0f, // bottom left
-		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  UV.x, 0.0f, // bottom left
-		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f, // bottom right
-		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, UV.y, // top right
-		// top
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, UV.y, // bottom left 
-		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  UV.x, 0.0f, // top right
-		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  UV.x, UV.y, // bottom right
-		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f, // bottom left
-		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  UV.x, 0.0f, // top right
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, UV.y  // top left
-	};
-
-	glGenVertexArrays(1, &cubeVAO);
-	glGenBuffers(1, &cubeVBO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glBindVertexArray(cubeVAO);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-}
-
-void cubeMeshSetup(unsigned int& cubeVBO, unsigned int& cubeVAO) {
-	float vertices[] = {
-		// positions          // normals           // texture coords
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-		 0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 1.0f,
-		-0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
-
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 0.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   1.0f, 1.0f,
-		-0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 1.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,   0.0f, 0.0f,
-
-		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-		-0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-		-0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-		-0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-		-0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-		 0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f,
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-		 0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 1.0f,
-		 0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  0.0f, 0.0f,
-		 0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f,
-
-		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-		 0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 1.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-		 0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  1.0f, 0.0f,
-		-0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 0.0f,
-		-0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,  0.0f, 1.0f,
-
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f,
-		 0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 1.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-		 0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  1.0f, 0.0f,
-		-0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
-		-0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
-	};
-
-	glGenVertexArrays(1, &cubeVAO);
-	glGenBuffers(1, &cubeVBO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-
-	glBindVertexArray(cubeVAO);
-
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-}
-
-unsigned int sphereMeshSetup(unsigned int& sphereVBO, unsigned int& sphereVAO, unsigned int& sphereEBO, int stacks, int sectors) {
-	vector<float> vertices;
-
-	for (int i = 0; i <= stacks; ++i) {
-		float stackAngle = glm::pi<float>() / 2.0f - i * (glm::pi<float>() / stacks); // from pi/2 to -pi/2
-		float xy = cosf(stackAngle);                     // r * cos(u)
-		float z = sinf(stackAngle);                      // r * sin(u)
-
-		for (int j = 0; j <= sectors; ++j) {
-			float sectorAngle = j * (2 * glm::pi<float>() / sectors); // from 0 to 2pi
-
-			float x = xy * cosf(sectorAngle);
-			float y = xy * sinf(sectorAngle);
-
-			// normalized position = normal for a sphere
-			float nx = x;
-			float ny = y;
-			float nz = z;
-
-			float u = (float)j / sectors;
-			float v = (float)i / stacks;
-
-			// position + normal + texcoord (8 floats)
-			vertices.push_back(x);
-			vertices.push_back(y);
-			vertices.push_back(z);
-
-			vertices.push_back(nx);
-			vertices.push_back(ny);
-			vertices.push_back(nz);
-
-			vertices.push_back(u);
-			vertices.push_back(v);
-		}
-	}
-
-	vector<unsigned int> indices;
-	for (int i = 0; i < stacks; ++i) {
-		int k1 = i * (sectors + 1);     // beginning of current stack
-		int k2 = k1 + sectors + 1;      // beginning of next stack
-
-		for (int j = 0; j < sectors; ++j, ++k1, ++k2) {
-			if (i != 0) {
-				// upper triangle
-				indices.push_back(k1);
-				indices.push_back(k2);
-				indices.push_back(k1 + 1);
-			}
-
-			if (i != (stacks - 1)) {
-				// lower triangle
-				indices.push_back(k1 + 1);
-				indices.push_back(k2);
-				indices.push_back(k2 + 1);
-			}
-		}
+void resolveSpecialCollision(Rigidbody& A, Rigidbody& B, const CollisionInfo& info) {
+	if (A == *ridingCube) {
+		//B.drawn = false;
+		//B.canCollide = false;
 	}
 
-	glGenVertexArrays(1, &sphereVAO);
-	glGenBuffers(1, &sphereVBO);
-	glGenBuffers(1, &sphereEBO);
-
-	glBindVertexArray(sphereVAO);
-
-	// Vertex buffer
-	glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-	// Index buffer
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
-
-	// Vertex attributes: position (0), normal (1), texCoord (2)
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-	glEnableVertexAttribArray(1);
-
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-	glEnableVertexAttribArray(2);
-
-	glBindVertexArray(0);
-
-	return static_cast<unsigned int>(indices.size());
-}
-
-CollisionInfo checkCollision(const SphereShape& obj1, const SphereShape& obj2) {
-	CollisionInfo info;
-
-	glm::vec3 posDiff = obj1.position - obj2.position;
-	float dist = glm::length(obj1.position - obj2.position);
-	float r = obj1.radius + obj2.radius;
-	if (dist < r) {
-		info.collided = true;
-		info.penetration = r - dist;
-		info.normal = (dist > 0.0f) ? posDiff / dist : glm::vec3(1, 0, 0);
+	if (B == *ridingCube) {
+		//A.drawn = false;
+		//A.canCollide = false;
 	}
-
-	return info;
 }
 
-CollisionInfo checkCollision(const SphereShape& obj1, const AABBShape& obj2) {
-	CollisionInfo info;
+void drawOpaqueGeometry(Shader& shader, Shader& indirectShader, const glm::mat4& view, const glm::mat4& projection)
+{
+	shader.use();
+	shader.setMat4("view", view);
+	shader.setMat4("projection", projection);
 
-	glm::vec3 closestPoint = glm::clamp(obj1.position, obj2.min(), obj2.max());
-	glm::vec3 posDiff = obj1.position - closestPoint;
-	float dist = glm::length(posDiff);
+	for (Object3D* object : opaqueObjects)
+		object->DrawGeometry(shader);
+	sphereLODs.DrawGeometry(shader);
 
-	if (dist < obj1.radius) {
-		info.collided = true;
-		info.penetration = obj1.radius - dist;
-		info.normal = (dist > 0.0f) ? posDiff / dist : glm::vec3(1, 0, 0);
-	}
+	indirectShader.use();
+	indirectShader.setMat4("view", view);
+	indirectShader.setMat4("projection", projection);
 
-	return info;
+	indirectRenderer.DrawGeometry(geometryArena, indirectShader);
 }
 
-CollisionInfo checkCollision(const AABBShape& obj1, const SphereShape& obj2) {
-	return checkCollision(obj2, obj1);
-}
-
-CollisionInfo checkCollision(const AABBShape& obj1, const AABBShape& obj2) {
-	CollisionInfo info;
+void scatterLights(int count)
+{
+	extraLightCount = count;
+	pointLights.resize(1);
 
-	glm::vec3 minA = obj1.min();
-	glm::vec3 minB = obj2.min();
-	glm::vec3 maxA = obj1.max();
-	glm::vec3 maxB = obj2.max();
+	// the same seed every time, so every benchmark run sees the same lights
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<float> spread(-30.0f, 30.0f);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
 
-	if ((minA.x <= maxB.x && maxA.x >= minB.x) &&
-		(minA.y <= maxB.y && maxA.y >= minB.y) &&
-		(minA.z <= maxB.z && maxA.z >= minB.z))
+	for (int i = 0; i < count; i++)
 	{
-		info.collided = true;
-
-
-		float overlapX = std::min(maxA.x, maxB.x) - std::max(minA.x, minB.x);
-		float overlapY = std::min(maxA.y, maxB.y) - std::max(minA.y, minB.y);
-		float overlapZ = std::min(maxA.z, maxB.z) - std::max(minA.z, minB.z);
-
-		if (overlapX < overlapY && overlapX < overlapZ) {
-			info.penetration = overlapX;
-			info.normal = (obj1.position.x < obj2.position.x) ? glm::vec3(-1, 0, 0) : glm::vec3(1, 0, 0);
-		}
-		else if (overlapY < overlapZ) {
-			info.penetration = overlapY;
-			info.normal = (obj1.position.y < obj2.position.y) ? glm::vec3(0, -1, 0) : glm::vec3(0, 1, 0);
-		}
-		else {
-			info.penetration = overlapZ;
-			info.normal = (obj1.position.z < obj2.position.z) ? glm::vec3(0, 0, -1) : glm::vec3(0, 0, 1);
-		}
+		glm::vec3 position;
+		position.x = spread(generator);
+		position.y = -1.2f + 3.0f * unit(generator);
+		position.z = spread(generator);
+
+		glm::vec3 color;
+		color.x = 1.5f * unit(generator);
+		color.y = 1.5f * unit(generator);
+		color.z = 1.5f * unit(generator);
+
+		float range = 3.0f + 5.0f * unit(generator);
+		pointLights.push_back(PointLight(i + 1, range, glm::vec3(0.0f), color, color, position));
 	}
-
-	return info;
 }
 
-CollisionInfo checkCollisions(const Rigidbody& obj1, const Rigidbody& obj2) {
-	CollisionInfo info;
+void startLightBenchmark()
+{
+	benchmarkSavedPath = shadingPath;
+	benchmarkSavedLights = extraLightCount;
 
-	if (!obj1.canCollide || !obj2.canCollide)
-		return info;
+	benchmarkStep = 0;
+	benchmarkFrame = 0;
+	benchmarkSum = 0.0f;
+	benchmarkDone = false;
 
-	return std::visit([](auto&& s1, auto&& s2) { return checkCollision(s1, s2); }, obj1.shape, obj2.shape);
+	shadingPath = SHADING_FORWARD;
+	scatterLights(benchmarkLightCounts[0] - 1);
 }
 
-void resolveCollision(Rigidbody& A, Rigidbody& B, const CollisionInfo& info) {
-	if (!info.collided) return;
-
-	resolveSpecialCollision(A, B, info);
-
-	if (A.behavior != ObjectType::DYNAMIC && B.behavior != ObjectType::DYNAMIC)
+void updateLightBenchmark()
+{
+	if (benchmarkStep < 0)
 		return;
 
-	glm::vec3 normal = glm::normalize(info.normal);
-
-	glm::vec3 relativeVelocity = A.velocity - B.velocity;
-
-	if (A.behavior != ObjectType::DYNAMIC)
-		glm::vec3 relativeVelocity = -B.velocity;
-	else if (B.behavior != ObjectType::DYNAMIC)
-		glm::vec3 relativeVelocity = A.velocity;
-
-	float velAlongNormal = glm::dot(relativeVelocity, normal);
-
-	if (velAlongNormal > 0.0f) return;
-
-	float restitution = 1.0f;
-
-	float invMassA = (A.mass > 0.0f) ? (1.0f / A.mass) : 0.0f;
-	float invMassB = (B.mass > 0.0f) ? (1.0f / B.mass) : 0.0f;
-
-	float j = -(1.0f + restitution) * velAlongNormal;
-	j /= (invMassA + invMassB);
-
-	glm::vec3 impulse = j * normal;
-
-	if (A.behavior == ObjectType::DYNAMIC)
-		A.velocity += (impulse * invMassA);
-
-	if (B.behavior == ObjectType::DYNAMIC)
-		B.velocity -= (impulse * invMassB);
-
-	const float percent = 0.2f;
-	const float slop = 0.01f;
-
-	glm::vec3 correction = (std::max(info.penetration - slop, 0.0f) / (invMassA + invMassB)) * percent * normal;
-
-	if (A.behavior == ObjectType::DYNAMIC)
-		A.SetPosition(A.GetPosition() - invMassA * correction);
-	if (B.behavior == ObjectType::DYNAMIC)
-		B.SetPosition(B.GetPosition() + invMassB * correction);
-}
+	// the first spans read back still belong to the previous step
+	if (benchmarkFrame >= BENCHMARK_WARMUP_FRAMES)
+		benchmarkSum += shadingTimer.GetTime();
+	if (++benchmarkFrame < BENCHMARK_WARMUP_FRAMES + BENCHMARK_FRAMES)
+		return;
 
-void resolveSpecialCollision(Rigidbody& A, Rigidbody& B, const CollisionInfo& info) {
-	if (A == *ridingCube) {
-		//B.drawn = false;
-		//B.canCollide = false;
-	}
+	benchmarkResults[benchmarkStep / SHADING_PATH_COUNT][benchmarkStep % SHADING_PATH_COUNT] = benchmarkSum / BENCHMARK_FRAMES;
+	benchmarkStep++;
+	benchmarkFrame = 0;
+	benchmarkSum = 0.0f;
 
-	if (B == *ridingCube) {
-		//A.drawn = false;
-		//A.canCollide = false;
+	if (benchmarkStep < SHADING_PATH_COUNT * BENCHMARK_STEP_COUNT)
+	{
+		shadingPath = benchmarkStep % SHADING_PATH_COUNT;
+		scatterLights(benchmarkLightCounts[benchmarkStep / SHADING_PATH_COUNT] - 1);
+		return;
 	}
-}
 
-void DrawWithOutline(Object3D obj, Shader& shader_, glm::vec3 color)
-{
-	Object3D outline = Object3D(obj.position, obj.rotation, obj.scale * 1.05f, obj.VAO, shader_,
-		obj.indexCount, obj.drawElements, 0, 0, 0, glm::vec2(0.0f), glm::vec3(0.0f));
-
-	glStencilFunc(GL_ALWAYS, 1, 0xFF);
-	glStencilMask(0xFF);
-	obj.Draw();
-
-	glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-	glStencilMask(0x00);
-	glDisable(GL_DEPTH_TEST);
-	shader_.use();
-	shader_.setVec3("color", color);
-	outline.Draw();
-	glEnable(GL_DEPTH_TEST);
+	std::cout << "Light benchmark, GPU shading time per frame:" << std::endl;
+	for (int i = 0; i < BENCHMARK_STEP_COUNT; i++)
+		std::cout << "  " << benchmarkLightCounts[i] << " lights: forward " << benchmarkResults[i][SHADING_FORWARD]
+			<< " ms, forward+ " << benchmarkResults[i][SHADING_FORWARD_PLUS]
+			<< " ms, deferred " << benchmarkResults[i][SHADING_DEFERRED] << " ms" << std::endl;
 
-	glStencilMask(0xFF);
-	glStencilFunc(GL_ALWAYS, 1, 0xFF);
+	benchmarkStep = -1;
+	benchmarkDone = true;
+	shadingPath = benchmarkSavedPath;
+	scatterLights(benchmarkSavedLights);
 }
\ No newline at end of file
@@ -0,0 +1,643 @@
+#include "mesh.h"
+
+#include "arena.h"
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace {
+    struct VertexHash {
+        size_t operator()(const Vertex& v) const {
+            uint32_t words[sizeof(Vertex) / sizeof(uint32_t)];
+            std::memcpy(words, &v, sizeof(Vertex));
+
+            // FNV-1a over the raw bits, identical vertices always hash alike
+            size_t hash = 2166136261u;
+            for (uint32_t word : words) {
+                hash = (hash ^ word) * 16777619u;
+            }
+            return hash;
+        }
+    };
+
+    struct VertexEqual {
+        bool operator()(const Vertex& a, const Vertex& b) const {
+            return std::memcmp(&a, &b, sizeof(Vertex)) == 0;
+        }
+    };
+
+    // Forsyth's tuning, see "Linear-Speed Vertex Cache Optimisation"
+    const int forsythCacheSize = 32;
+    const float cacheDecayPower = 1.5f;
+    const float lastTriangleScore = 0.75f;
+    const float valenceBoostScale = 2.0f;
+    const float valenceBoostPower = 0.5f;
+
+    struct PackedVertex {
+        glm::vec3 position;
+        uint32_t normal;
+        uint16_t texCoords[2];
+    };
+
+    struct QuantizedVertex {
+        int16_t position[3];
+        int16_t padding; // keeps the normal 4-byte aligned
+        uint32_t normal;
+        uint16_t texCoords[2];
+    };
+
+    static_assert(sizeof(PackedVertex) == 20, "PackedVertex must stay tightly packed");
+    static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex must stay tightly packed");
+
+    uint32_t packNormal(const glm::vec3& normal) {
+        return glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+    }
+
+    float vertexScore(int cachePosition, unsigned int remainingTriangles) {
+        if (remainingTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            // the three most recent vertices get a fixed score so the next
+            // triangle doesn't just reuse the edge of the last one
+            if (cachePosition < 3) {
+                score = lastTriangleScore;
+            }
+            else {
+                float scaler = 1.0f / (forsythCacheSize - 3);
+                score = powf(1.0f - (cachePosition - 3) * scaler, cacheDecayPower);
+            }
+        }
+
+        // vertices with few triangles left are worth finishing off
+        score += valenceBoostScale * powf(static_cast<float>(remainingTriangles), -valenceBoostPower);
+        return score;
+    }
+}
+
+const char* vertexFormatName(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::FLOAT: return "Float (32 B)";
+    case VertexFormat::PACKED: return "Packed (20 B)";
+    case VertexFormat::QUANTIZED: return "Quantized (16 B)";
+    }
+    return "";
+}
+
+unsigned int vertexFormatSize(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::FLOAT: return sizeof(Vertex);
+    case VertexFormat::PACKED: return sizeof(PackedVertex);
+    case VertexFormat::QUANTIZED: return sizeof(QuantizedVertex);
+    }
+    return 0;
+}
+
+std::vector<unsigned char> encodeVertices(const std::vector<Vertex>& vertices, VertexFormat format) {
+    std::vector<unsigned char> data(vertices.size() * vertexFormatSize(format));
+
+    for (unsigned int i = 0; i < vertices.size(); i++) {
+        const Vertex& v = vertices[i];
+
+        if (format == VertexFormat::FLOAT) {
+            std::memcpy(&data[i * sizeof(Vertex)], &v, sizeof(Vertex));
+        }
+        else if (format == VertexFormat::PACKED) {
+            PackedVertex packed;
+            packed.position = v.position;
+            packed.normal = packNormal(v.normal);
+            packed.texCoords[0] = glm::packHalf1x16(v.texCoords.x);
+            packed.texCoords[1] = glm::packHalf1x16(v.texCoords.y);
+            std::memcpy(&data[i * sizeof(PackedVertex)], &packed, sizeof(PackedVertex));
+        }
+        else {
+            QuantizedVertex quantized;
+            quantized.position[0] = static_cast<int16_t>(glm::packSnorm1x16(v.position.x));
+            quantized.position[1] = static_cast<int16_t>(glm::packSnorm1x16(v.position.y));
+            quantized.position[2] = static_cast<int16_t>(glm::packSnorm1x16(v.position.z));
+            quantized.padding = 0;
+            quantized.normal = packNormal(v.normal);
+            quantized.texCoords[0] = glm::packHalf1x16(v.texCoords.x);
+            quantized.texCoords[1] = glm::packHalf1x16(v.texCoords.y);
+            std::memcpy(&data[i * sizeof(QuantizedVertex)], &quantized, sizeof(QuantizedVertex));
+        }
+    }
+
+    return data;
+}
+
+
+void setVertexAttributes(VertexFormat format) {
+    GLsizei stride = vertexFormatSize(format);
+
+    // normals and texCoords are normalized or half floats, the fetch hands the shader floats
+    if (format == VertexFormat::FLOAT) {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, position));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, normal));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Vertex, texCoords));
+    }
+    else if (format == VertexFormat::PACKED) {
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, position));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(PackedVertex, normal));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(PackedVertex, texCoords));
+    }
+    else {
+        glVertexAttribPointer(0, 3, GL_SHORT, GL_TRUE, stride, (void*)offsetof(QuantizedVertex, position));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride, (void*)offsetof(QuantizedVertex, normal));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, stride, (void*)offsetof(QuantizedVertex, texCoords));
+    }
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+}
+
+#pragma region Mesh Generation
+void generateCube(glm::vec2 UV, std::vector<Vertex>& vertices) {
+    // normal, then u and v axes with u x v = normal so corners come out CCW
+    const glm::vec3 faces[6][3] = {
+        { glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(-1.0f, 0.0f,  0.0f), glm::vec3(0.0f, 1.0f,  0.0f) }, // back
+        { glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f, 1.0f,  0.0f) }, // front
+        { glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3( 0.0f, 0.0f,  1.0f), glm::vec3(0.0f, 1.0f,  0.0f) }, // left
+        { glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3( 0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f,  0.0f) }, // right
+        { glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f, 0.0f,  1.0f) }, // bottom
+        { glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3( 1.0f, 0.0f,  0.0f), glm::vec3(0.0f, 0.0f, -1.0f) }  // top
+    };
+
+    for (const auto& face : faces) {
+        const glm::vec3& normal = face[0];
+        const glm::vec3& u = face[1];
+        const glm::vec3& v = face[2];
+
+        Vertex corners[4] = {
+            { normal * 0.5f - u * 0.5f - v * 0.5f, normal, glm::vec2(0.0f, 0.0f) }, // bottom left
+            { normal * 0.5f + u * 0.5f - v * 0.5f, normal, glm::vec2(UV.x, 0.0f) }, // bottom right
+            { normal * 0.5f + u * 0.5f + v * 0.5f, normal, glm::vec2(UV.x, UV.y) }, // top right
+            { normal * 0.5f - u * 0.5f + v * 0.5f, normal, glm::vec2(0.0f, UV.y) }  // top left
+        };
+
+        vertices.push_back(corners[0]);
+        vertices.push_back(corners[1]);
+        vertices.push_back(corners[2]);
+
+        vertices.push_back(corners[0]);
+        vertices.push_back(corners[2]);
+        vertices.push_back(corners[3]);
+    }
+}
+
+// Unit radius, poles on z. The seam column is doubled so u can run from 0 to 1.
+void generateSphere(int stacks, int sectors, std::vector<Vertex>& vertices) {
+    std::vector<Vertex> grid;
+    grid.reserve((stacks + 1) * (sectors + 1));
+
+    for (int i = 0; i <= stacks; ++i) {
+        float stackAngle = glm::pi<float>() / 2.0f - i * (glm::pi<float>() / stacks); // from pi/2 to -pi/2
+        float xy = cosf(stackAngle);
+        float z = sinf(stackAngle);
+
+        for (int j = 0; j <= sectors; ++j) {
+            float sectorAngle = j * (2 * glm::pi<float>() / sectors); // from 0 to 2pi
+
+            // normalized position = normal for a sphere
+            glm::vec3 position(xy * cosf(sectorAngle), xy * sinf(sectorAngle), z);
+            grid.push_back({ position, position, glm::vec2((float)j / sectors, (float)i / stacks) });
+        }
+    }
+
+    for (int i = 0; i < stacks; ++i) {
+        int k1 = i * (sectors + 1); // beginning of current stack
+        int k2 = k1 + sectors + 1;  // beginning of next stack
+
+        for (int j = 0; j < sectors; ++j, ++k1, ++k2) {
+            if (i != 0) {
+                vertices.push_back(grid[k1]);
+                vertices.push_back(grid[k2]);
+                vertices.push_back(grid[k1 + 1]);
+            }
+
+            if (i != (stacks - 1)) {
+                vertices.push_back(grid[k1 + 1]);
+                vertices.push_back(grid[k2]);
+                vertices.push_back(grid[k2 + 1]);
+            }
+        }
+    }
+}
+
+// Unit square on y = 0 facing up, split into subdivisions x subdivisions quads.
+void generatePlane(int subdivisions, glm::vec2 UV, std::vector<Vertex>& vertices) {
+    const glm::vec3 normal(0.0f, 1.0f, 0.0f);
+
+    auto corner = [&](int a, int b) {
+        float s = (float)a / subdivisions;
+        float t = (float)b / subdivisions;
+        return Vertex{ glm::vec3(s - 0.5f, 0.0f, 0.5f - t), normal, glm::vec2(s * UV.x, t * UV.y) };
+    };
+
+    for (int b = 0; b < subdivisions; b++) {
+        for (int a = 0; a < subdivisions; a++) {
+            vertices.push_back(corner(a, b));
+            vertices.push_back(corner(a + 1, b));
+            vertices.push_back(corner(a + 1, b + 1));
+
+            vertices.push_back(corner(a, b));
+            vertices.push_back(corner(a + 1, b + 1));
+            vertices.push_back(corner(a, b + 1));
+        }
+    }
+}
+#pragma endregion
+
+#pragma region Mesh Optimization
+void deduplicateVertices(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    std::unordered_map<Vertex, unsigned int, VertexHash, VertexEqual> unique;
+    unique.reserve(vertices.size());
+
+    std::vector<Vertex> merged;
+    indices.clear();
+    indices.reserve(vertices.size());
+
+    for (const Vertex& vertex : vertices) {
+        auto [it, inserted] = unique.emplace(vertex, static_cast<unsigned int>(merged.size()));
+        if (inserted)
+            merged.push_back(vertex);
+
+        indices.push_back(it->second);
+    }
+
+    vertices.swap(merged);
+}
+
+// Greedily emits the best scoring triangle that touches the simulated LRU cache,
+// only rescoring triangles around the vertices whose cache position changed.
+void optimizeVertexCache(std::vector<unsigned int>& indices, unsigned int vertexCount) {
+    unsigned int triangleCount = static_cast<unsigned int>(indices.size() / 3);
+    if (triangleCount == 0)
+        return;
+
+    // vertex -> triangles, packed. Emitted triangles are swapped out of each
+    // vertex's range, so the first `remaining` entries are the live ones.
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+    for (unsigned int index : indices) {
+        adjacencyOffset[index + 1]++;
+    }
+    for (unsigned int v = 0; v < vertexCount; v++) {
+        adjacencyOffset[v + 1] += adjacencyOffset[v];
+    }
+
+    std::vector<unsigned int> adjacency(indices.size());
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int t = 0; t < triangleCount; t++) {
+        for (int k = 0; k < 3; k++) {
+            unsigned int v = indices[t * 3 + k];
+            adjacency[adjacencyOffset[v] + remaining[v]++] = t;
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> scores(vertexCount);
+    for (unsigned int v = 0; v < vertexCount; v++) {
+        scores[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<char> emitted(triangleCount, 0);
+    int best = 0;
+    for (unsigned int t = 0; t < triangleCount; t++) {
+        triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+        if (triangleScores[t] > triangleScores[best])
+            best = t;
+    }
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+
+    std::vector<unsigned int> cache;
+    std::vector<unsigned int> nextCache;
+    cache.reserve(forsythCacheSize + 3);
+    nextCache.reserve(forsythCacheSize + 3);
+
+    unsigned int scanCursor = 0;
+    while (result.size() < indices.size()) {
+        if (best < 0) {
+            // nothing in the cache has triangles left, restart from input order
+            while (emitted[scanCursor])
+                scanCursor++;
+            best = scanCursor;
+        }
+
+        unsigned int triangle[3] = { indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2] };
+        emitted[best] = 1;
+
+        for (unsigned int v : triangle) {
+            result.push_back(v);
+
+            unsigned int begin = adjacencyOffset[v];
+            unsigned int end = begin + remaining[v];
+            for (unsigned int i = begin; i < end; i++) {
+                if (adjacency[i] == static_cast<unsigned int>(best)) {
+                    std::swap(adjacency[i], adjacency[end - 1]);
+                    break;
+                }
+            }
+            remaining[v]--;
+        }
+
+        // the emitted triangle moves to the front, everything else shifts back
+        nextCache.assign(triangle, triangle + 3);
+        for (unsigned int v : cache) {
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2])
+                nextCache.push_back(v);
+        }
+
+        for (unsigned int i = 0; i < nextCache.size(); i++) {
+            unsigned int v = nextCache[i];
+            cachePosition[v] = static_cast<int>(i) < forsythCacheSize ? static_cast<int>(i) : -1;
+            scores[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+
+        best = -1;
+        float bestScore = -1.0f;
+        for (unsigned int v : nextCache) {
+            unsigned int begin = adjacencyOffset[v];
+            for (unsigned int i = begin; i < begin + remaining[v]; i++) {
+                unsigned int t = adjacency[i];
+                triangleScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+                if (triangleScores[t] > bestScore) {
+                    bestScore = triangleScores[t];
+                    best = t;
+                }
+            }
+        }
+
+        if (nextCache.size() > forsythCacheSize)
+            nextCache.resize(forsythCacheSize);
+        cache.swap(nextCache);
+    }
+
+    indices.swap(result);
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<unsigned int>& indices) {
+    const unsigned int unused = ~0u;
+    std::vector<unsigned int> remap(vertices.size(), unused);
+
+    std::vector<Vertex> ordered;
+    ordered.reserve(vertices.size());
+
+    for (unsigned int& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = static_cast<unsigned int>(ordered.size());
+            ordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+
+    vertices.swap(ordered);
+}
+
+float computeACMR(const std::vector<unsigned int>& indices, unsigned int vertexCount, unsigned int cacheSize) {
+    if (indices.size() < 3)
+        return 0.0f;
+
+    // a vertex is cached while fewer than cacheSize misses happened since it was loaded
+    std::vector<unsigned int> loadedAt(vertexCount, 0);
+    unsigned int time = cacheSize + 1;
+    unsigned int misses = 0;
+
+    for (unsigned int index : indices) {
+        if (time - loadedAt[index] > cacheSize) {
+            loadedAt[index] = time++;
+            misses++;
+        }
+    }
+
+    return static_cast<float>(misses) / (indices.size() / 3);
+}
+#pragma endregion
+
+#pragma region Mesh Methods
+Mesh::Mesh() : VAO(0), VBO(0), EBO(0), indexCount(0), indexType(GL_UNSIGNED_INT), format(VertexFormat::FLOAT), radius(0.0f), stats(), arenaRange() {}
+
+Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, VertexFormat format_) :
+    indexCount(static_cast<unsigned int>(indices.size())), format(format_), radius(0.0f), stats(), arenaRange()
+{
+    for (const Vertex& v : vertices)
+        radius = std::max(radius, glm::length(v.position));
+
+    if (format == VertexFormat::QUANTIZED) {
+        for (const Vertex& v : vertices) {
+            glm::vec3 extent = glm::abs(v.position);
+            if (extent.x > 1.0f || extent.y > 1.0f || extent.z > 1.0f) {
+                format = VertexFormat::PACKED;
+                break;
+            }
+        }
+    }
+
+    std::vector<unsigned char> vertexData = encodeVertices(vertices, format);
+
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertexData.size(), vertexData.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    if (vertices.size() <= 0x10000) {
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, shortIndices.size() * sizeof(uint16_t), shortIndices.data(), GL_STATIC_DRAW);
+        indexType = GL_UNSIGNED_SHORT;
+        stats.indexBytes = static_cast<unsigned int>(shortIndices.size() * sizeof(uint16_t));
+    }
+    else {
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        indexType = GL_UNSIGNED_INT;
+        stats.indexBytes = static_cast<unsigned int>(indices.size() * sizeof(unsigned int));
+    }
+    stats.vertexBytes = static_cast<unsigned int>(vertexData.size());
+
+    setVertexAttributes(format);
+
+    glBindVertexArray(0);
+}
+
+Mesh::~Mesh() {
+    release();
+}
+
+Mesh::Mesh(Mesh&& other) noexcept :
+    VAO(other.VAO), VBO(other.VBO), EBO(other.EBO), indexCount(other.indexCount), indexType(other.indexType),
+    format(other.format), radius(other.radius), stats(other.stats), arenaRange(other.arenaRange)
+{
+    other.VAO = 0;
+    other.VBO = 0;
+    other.EBO = 0;
+    other.indexCount = 0;
+}
+
+Mesh& Mesh::operator=(Mesh&& other) noexcept {
+    if (this == &other) return *this;
+
+    release();
+
+    VAO = other.VAO;
+    VBO = other.VBO;
+    EBO = other.EBO;
+    indexCount = other.indexCount;
+    indexType = other.indexType;
+    format = other.format;
+    radius = other.radius;
+    stats = other.stats;
+    arenaRange = other.arenaRange;
+
+    other.VAO = 0;
+    other.VBO = 0;
+    other.EBO = 0;
+    other.indexCount = 0;
+    return *this;
+}
+
+void Mesh::release() {
+    if (VAO == 0)
+        return;
+
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+
+    VAO = 0;
+    VBO = 0;
+    EBO = 0;
+}
+#pragma endregion
+
+#pragma region MeshCache Methods
+MeshCache::MeshCache(VertexFormat format_, GeometryArena* arena_) : format(format_), arena(arena_) {}
+
+Mesh& MeshCache::GetCube(glm::vec2 UV) {
+    Key key(MeshKind::CUBE, 0, 0, UV.x, UV.y);
+    auto it = meshes.find(key);
+    if (it != meshes.end())
+        return it->second;
+
+    return meshes.emplace(key, build(key)).first->second;
+}
+
+Mesh& MeshCache::GetSphere(int stacks, int sectors) {
+    Key key(MeshKind::SPHERE, stacks, sectors, 0.0f, 0.0f);
+    auto it = meshes.find(key);
+    if (it != meshes.end())
+        return it->second;
+
+    return meshes.emplace(key, build(key)).first->second;
+}
+
+Mesh& MeshCache::GetPlane(int subdivisions, glm::vec2 UV) {
+    Key key(MeshKind::PLANE, subdivisions, 0, UV.x, UV.y);
+    auto it = meshes.find(key);
+    if (it != meshes.end())
+        return it->second;
+
+    return meshes.emplace(key, build(key)).first->second;
+}
+
+void MeshCache::SetArena(GeometryArena* arena_) {
+    arena = arena_;
+}
+
+void MeshCache::SetFormat(VertexFormat format_) {
+    if (format == format_)
+        return;
+
+    format = format_;
+    if (arena != nullptr)
+        arena->Reset(format);
+
+    for (auto& [key, mesh] : meshes) {
+        mesh = build(key);
+    }
+}
+
+VertexFormat MeshCache::GetFormat() const {
+    return format;
+}
+
+void MeshCache::Clear() {
+    meshes.clear();
+}
+
+unsigned int MeshCache::GetMeshCount() const {
+    return static_cast<unsigned int>(meshes.size());
+}
+
+unsigned int MeshCache::GetVertexBytes() const {
+    unsigned int bytes = 0;
+    for (const auto& [key, mesh] : meshes) {
+        bytes += mesh.stats.vertexBytes;
+    }
+    return bytes;
+}
+
+unsigned int MeshCache::GetIndexBytes() const {
+    unsigned int bytes = 0;
+    for (const auto& [key, mesh] : meshes) {
+        bytes += mesh.stats.indexBytes;
+    }
+    return bytes;
+}
+
+void MeshCache::generate(const Key& key, std::vector<Vertex>& vertices) const {
+    const auto& [kind, a, b, u, v] = key;
+
+    switch (kind) {
+    case MeshKind::CUBE:
+        generateCube(glm::vec2(u, v), vertices);
+        break;
+    case MeshKind::SPHERE:
+        generateSphere(a, b, vertices);
+        break;
+    case MeshKind::PLANE:
+        generatePlane(a, glm::vec2(u, v), vertices);
+        break;
+    }
+}
+
+Mesh MeshCache::build(const Key& key) const {
+    std::vector<Vertex> vertices;
+    generate(key, vertices);
+
+    MeshStats stats;
+    stats.triangleCount = static_cast<unsigned int>(vertices.size() / 3);
+    stats.soupVertexCount = static_cast<unsigned int>(vertices.size());
+
+    std::vector<unsigned int> indices;
+    deduplicateVertices(vertices, indices);
+    stats.acmrGenerated = computeACMR(indices, static_cast<unsigned int>(vertices.size()));
+
+    optimizeVertexCache(indices, static_cast<unsigned int>(vertices.size()));
+    optimizeVertexFetch(vertices, indices);
+    stats.vertexCount = static_cast<unsigned int>(vertices.size());
+    stats.acmrOptimized = computeACMR(indices, stats.vertexCount);
+
+    Mesh mesh(vertices, indices, format);
+    if (arena != nullptr && mesh.format == arena->GetFormat())
+        arena->Add(vertices, indices, mesh.arenaRange);
+
+    stats.vertexBytes = mesh.stats.vertexBytes;
+    stats.indexBytes = mesh.stats.indexBytes;
+    mesh.stats = stats;
+    return mesh;
+}
+#pragma endregion
@@ -1,5 +1,10 @@
 #include "objects.h"
 
+#include "mesh.h"
+#include "streambuffer.h"
+
+#include <algorithm>
+
 #pragma region CollisionInfo Methods
 CollisionInfo::CollisionInfo(bool collided_, glm::vec3 normal_, float penetration_) :
     collided(collided_), normal(normal_), penetration(penetration_) {}
@@ -23,6 +28,9 @@ glm::vec3 AABBShape::max() const {
 #pragma endregion
 
 #pragma region Object3D Methods
+StreamBuffer* Object3D::streamBuffer = nullptr;
+unsigned int Object3D::objectDataBuffer = 0;
+
 Object3D::Object3D(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
     unsigned int& VAO_,
     Shader& shader_,
@@ -40,9 +48,24 @@ Object3D::Object3D(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
     texture2 = texture2_;
     texture3 = texture3_;
     drawElements = drawElements_;
+    indexType = GL_UNSIGNED_INT;
+    mesh = nullptr;
+    lights = glm::ivec4(-1);
     drawn = true;
 };
 
+Object3D::Object3D(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
+    Mesh& mesh_,
+    Shader& shader_,
+    unsigned int texture1_, unsigned int texture2_, unsigned int texture3_,
+    glm::vec2 UVScale_, glm::vec3 color_) :
+    Object3D(position_, rotation_, scale_, mesh_.VAO, shader_, mesh_.indexCount, true,
+        texture1_, texture2_, texture3_, UVScale_, color_)
+{
+    indexType = mesh_.indexType;
+    mesh = &mesh_;
+}
+
 Object3D& Object3D::operator=(const Object3D& other) {
     if (this == &other) return *this; // self-assignment guard
 
@@ -53,6 +76,9 @@ Object3D& Object3D::operator=(const Object3D& other) {
     this->VAO = other.VAO;
     this->shader = other.shader;
     this->drawElements = other.drawElements;
+    this->indexType = other.indexType;
+    this->mesh = other.mesh;
+    this->lights = other.lights;
     this->drawn = other.drawn;
 
     return *this;
@@ -72,13 +98,46 @@ glm::mat4 Object3D::GetModelMatrix() {
     return model;
 }
 
+glm::vec4 Object3D::GetBounds() {
+    // raw VAOs are the unit cube, half a diagonal from its center
+    float radius = mesh != nullptr ? mesh->radius : 0.8660254f;
+    return glm::vec4(position, radius * std::max(std::max(scale.x, scale.y), scale.z));
+}
+
 void Object3D::Draw(unsigned int type) {
     if (!drawn)
         return;
 
+    Bind(type);
+
+    glBindVertexArray(VAO);
+
+    if (!drawElements) {
+        glDrawArrays(GL_TRIANGLES, 0, indexCount);
+    }
+    else {
+        glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
+    }
+}
+
+void Object3D::Bind(unsigned int type) {
     shader.use();
-    shader.setMat4("model", GetModelMatrix());
-    shader.setVec2("scaleUV", UVScale);
+
+    if (shader.usesObjectData && streamBuffer != nullptr) {
+        ObjectData data = { GetModelMatrix(), glm::vec4(UVScale.x, UVScale.y, 0.0f, 0.0f), glm::vec4(color, 1.0f), lights };
+        if (streamBuffer->BindUniform(OBJECT_DATA_BINDING, &data, sizeof(ObjectData)) < 0) {
+            // the block is the shader's only source for these, a stale binding would draw another object
+            if (objectDataBuffer == 0)
+                glGenBuffers(1, &objectDataBuffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, objectDataBuffer);
+            glBufferData(GL_UNIFORM_BUFFER, sizeof(ObjectData), &data, GL_STREAM_DRAW);
+            glBindBufferBase(GL_UNIFORM_BUFFER, OBJECT_DATA_BINDING, objectDataBuffer);
+        }
+    }
+    else {
+        shader.setMat4("model", GetModelMatrix());
+        shader.setVec2("scaleUV", UVScale);
+    }
 
     if (texture1 != 0) {
         glActiveTexture(GL_TEXTURE0);
@@ -95,10 +154,17 @@ void Object3D::Draw(unsigned int type) {
         glBindTexture(type, texture3);
     }
 
-    if (texture1 == 0 && texture2 == 0 && texture3 == 0) {
+    if (texture1 == 0 && texture2 == 0 && texture3 == 0 && !shader.usesObjectData) {
         //shader.setVec3("material.ambient", color);
         shader.setVec3("material.diffuse", color);
     }
+}
+
+void Object3D::DrawGeometry(Shader& shader_) {
+    if (!drawn)
+        return;
+
+    shader_.setMat4("model", GetModelMatrix());
 
     glBindVertexArray(VAO);
 
@@ -106,7 +172,7 @@ void Object3D::Draw(unsigned int type) {
         glDrawArrays(GL_TRIANGLES, 0, indexCount);
     }
     else {
-        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_TRIANGLES, indexCount, indexType, 0);
     }
 }
 
@@ -150,7 +216,7 @@ Rigidbody::Rigidbody(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
     bool drawElements_,
     float mass_,
     ObjectType type_,
-    //ShapeType shape_ = SphereShape(glm::vec3(0.0f), -1.0f),
+    ShapeType shapeType_,
     unsigned int texture1_, unsigned int texture2_, unsigned int texture3_,
     glm::vec2 UVScale, glm::vec3 color) : 
     Object3D(position_, rotation_, scale_, VAO_, shader_, indexCount_, drawElements_, texture1_, texture2_, texture3_, UVScale, color)
@@ -159,8 +225,13 @@ Rigidbody::Rigidbody(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
     acceleration = glm::vec3(0.0f);
     mass = mass_;
     behavior = type_;
+    canCollide = true;
+    restitution = 1.0f;
+    ccd = false;
+    sleeping = false;
+    sleepTimer = 0.0f;
 
-    if (drawElements_) { // sphere
+    if (shapeType_ == ShapeType::SPHERE) {
         shape = SphereShape(position_, scale_.x);
     }
     else {
@@ -168,6 +239,21 @@ Rigidbody::Rigidbody(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
     }
 }
 
+Rigidbody::Rigidbody(glm::vec3 position_, glm::vec3 rotation_, glm::vec3 scale_,
+    Mesh& mesh_,
+    Shader& shader_,
+    float mass_,
+    ObjectType type_,
+    ShapeType shapeType_,
+    unsigned int texture1_, unsigned int texture2_, unsigned int texture3_,
+    glm::vec2 UVScale, glm::vec3 color) :
+    Rigidbody(position_, rotation_, scale_, mesh_.VAO, shader_, mesh_.indexCount, true, mass_, type_, shapeType_,
+        texture1_, texture2_, texture3_, UVScale, color)
+{
+    indexType = mesh_.indexType;
+    mesh = &mesh_;
+}
+
 Rigidbody& Rigidbody::operator=(const Rigidbody& other) {
     if (this == &other) return *this; // self-assignment guard
 
@@ -176,6 +262,11 @@ Rigidbody& Rigidbody::operator=(const Rigidbody& other) {
     this->mass = other.mass;
     this->shape = other.shape;
     this->behavior = other.behavior;
+    this->canCollide = other.canCollide;
+    this->restitution = other.restitution;
+    this->ccd = other.ccd;
+    this->sleeping = other.sleeping;
+    this->sleepTimer = other.sleepTimer;
 
     this->indexCount = other.indexCount;
     this->texture1 = other.texture1;
@@ -184,6 +275,9 @@ Rigidbody& Rigidbody::operator=(const Rigidbody& other) {
     this->VAO = other.VAO;
     this->shader = other.shader;
     this->drawElements = other.drawElements;
+    this->indexType = other.indexType;
+    this->mesh = other.mesh;
+    this->lights = other.lights;
     this->drawn = other.drawn;
 
     return *this;
@@ -193,19 +287,43 @@ void Rigidbody::ApplyForce(const glm::vec3& force) {
     if (behavior != ObjectType::DYNAMIC)
         return;
 
+    if (sleeping)
+        Wake();
+
     acceleration += force / mass;
 }
 
 void Rigidbody::PhysicsProcess(float deltaTime) {
+    IntegrateVelocity(deltaTime);
+    IntegratePosition();
+}
+
+void Rigidbody::IntegrateVelocity(float deltaTime) {
     if (behavior != ObjectType::DYNAMIC)
         return;
 
     velocity += acceleration * deltaTime;
+    acceleration = glm::vec3(0.0f);
+}
+
+void Rigidbody::IntegratePosition() {
+    if (behavior != ObjectType::DYNAMIC)
+        return;
+
     SetPosition(position + velocity);
+}
 
+void Rigidbody::Sleep() {
+    sleeping = true;
+    velocity = glm::vec3(0.0f);
     acceleration = glm::vec3(0.0f);
 }
 
+void Rigidbody::Wake() {
+    sleeping = false;
+    sleepTimer = 0.0f;
+}
+
 void Rigidbody::SetPosition(glm::vec3 position_) {
     if (behavior == ObjectType::STATIC)
         return;
@@ -0,0 +1,238 @@
+#include "occlusion.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool projectSphereBounds(const glm::vec3& center, float radius, const glm::mat4& viewProjection,
+    glm::vec2& rectMin, glm::vec2& rectMax, float& nearestDepth) {
+    rectMin = glm::vec2(1.0f);
+    rectMax = glm::vec2(0.0f);
+    nearestDepth = 1.0f;
+
+    // corners of the box around the sphere, cheaper than the exact projected ellipse
+    for (int i = 0; i < 8; i++) {
+        glm::vec3 corner = center + radius * glm::vec3(
+            (i & 1) ? 1.0f : -1.0f,
+            (i & 2) ? 1.0f : -1.0f,
+            (i & 4) ? 1.0f : -1.0f);
+
+        glm::vec4 clip = viewProjection * glm::vec4(corner, 1.0f);
+        if (clip.w <= 1e-5f)
+            return false;
+
+        glm::vec3 ndc = glm::vec3(clip) / clip.w;
+        glm::vec2 uv = glm::vec2(ndc) * 0.5f + 0.5f;
+
+        rectMin = glm::min(rectMin, uv);
+        rectMax = glm::max(rectMax, uv);
+        nearestDepth = std::min(nearestDepth, ndc.z * 0.5f + 0.5f);
+    }
+
+    rectMin = glm::clamp(rectMin, glm::vec2(0.0f), glm::vec2(1.0f));
+    rectMax = glm::clamp(rectMax, glm::vec2(0.0f), glm::vec2(1.0f));
+    nearestDepth = std::max(nearestDepth, 0.0f);
+    return true;
+}
+
+int hiZLevel(const glm::vec2& size, int levelCount) {
+    float extent = std::max(size.x, size.y);
+    int level = extent > 1.0f ? static_cast<int>(std::ceil(std::log2(extent))) : 0;
+
+    return std::min(level, levelCount - 1);
+}
+
+#pragma region SoftwareOcclusion Methods
+SoftwareOcclusion::SoftwareOcclusion(int width_, int height_) :
+    width(0), height(0), viewProjection(1.0f), triangleCount(0) {
+    Resize(width_, height_);
+}
+
+void SoftwareOcclusion::Resize(int width_, int height_) {
+    width = std::max(width_, 1);
+    height = std::max(height_, 1);
+
+    levels.clear();
+    levelSizes.clear();
+
+    glm::ivec2 size(width, height);
+    while (true) {
+        levelSizes.push_back(size);
+        levels.emplace_back(size.x * size.y, 1.0f);
+
+        if (size.x == 1 && size.y == 1)
+            break;
+        size = glm::max(size / 2, glm::ivec2(1));
+    }
+}
+
+void SoftwareOcclusion::Begin(const glm::mat4& viewProjection_) {
+    viewProjection = viewProjection_;
+    triangleCount = 0;
+
+    std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+}
+
+void SoftwareOcclusion::AddTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
+    rasterize(viewProjection * glm::vec4(a, 1.0f), viewProjection * glm::vec4(b, 1.0f), viewProjection * glm::vec4(c, 1.0f));
+}
+
+void SoftwareOcclusion::AddBox(const glm::vec3& min, const glm::vec3& max) {
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; i++) {
+        corners[i] = glm::vec3(
+            (i & 1) ? max.x : min.x,
+            (i & 2) ? max.y : min.y,
+            (i & 4) ? max.z : min.z);
+    }
+
+    // two triangles per face, winding doesn't matter since nothing is back-face culled
+    static const int faces[6][4] = {
+        { 0, 2, 6, 4 }, { 1, 3, 7, 5 }, // -x, +x
+        { 0, 1, 5, 4 }, { 2, 3, 7, 6 }, // -y, +y
+        { 0, 1, 3, 2 }, { 4, 5, 7, 6 }  // -z, +z
+    };
+
+    for (const int* face : faces) {
+        AddTriangle(corners[face[0]], corners[face[1]], corners[face[2]]);
+        AddTriangle(corners[face[0]], corners[face[2]], corners[face[3]]);
+    }
+}
+
+// Every texel keeps the farthest depth of the texels below it. Odd sizes fold
+// their last row and column into the last texel so nothing is dropped.
+void SoftwareOcclusion::End() {
+    for (size_t level = 1; level < levels.size(); level++) {
+        const std::vector<float>& source = levels[level - 1];
+        glm::ivec2 sourceSize = levelSizes[level - 1];
+        glm::ivec2 size = levelSizes[level];
+
+        for (int y = 0; y < size.y; y++) {
+            int y0 = y * 2;
+            int y1 = (y == size.y - 1) ? sourceSize.y - 1 : std::min(y0 + 1, sourceSize.y - 1);
+
+            for (int x = 0; x < size.x; x++) {
+                int x0 = x * 2;
+                int x1 = (x == size.x - 1) ? sourceSize.x - 1 : std::min(x0 + 1, sourceSize.x - 1);
+
+                float farthest = 0.0f;
+                for (int sy = y0; sy <= y1; sy++)
+                    for (int sx = x0; sx <= x1; sx++)
+                        farthest = std::max(farthest, source[sy * sourceSize.x + sx]);
+
+                levels[level][y * size.x + x] = farthest;
+            }
+        }
+    }
+}
+
+bool SoftwareOcclusion::IsOccluded(const glm::vec3& center, float radius) const {
+    glm::vec2 rectMin, rectMax;
+    float nearestDepth;
+    if (!projectSphereBounds(center, radius, viewProjection, rectMin, rectMax, nearestDepth))
+        return false;
+
+    int level = hiZLevel((rectMax - rectMin) * glm::vec2(width, height), GetLevelCount());
+    glm::ivec2 size = levelSizes[level];
+
+    // in base-level pixels shifted down, scaling by the level size can land a texel short
+    // of the odd row or column End folded in
+    glm::ivec2 pixelMin = glm::ivec2(rectMin * glm::vec2(width, height));
+    glm::ivec2 pixelMax = glm::ivec2(rectMax * glm::vec2(width, height));
+    glm::ivec2 texelMin = glm::clamp(glm::ivec2(pixelMin.x >> level, pixelMin.y >> level), glm::ivec2(0), size - 1);
+    glm::ivec2 texelMax = glm::clamp(glm::ivec2(pixelMax.x >> level, pixelMax.y >> level), glm::ivec2(0), size - 1);
+
+    float farthest = std::max(
+        std::max(GetDepth(level, texelMin.x, texelMin.y), GetDepth(level, texelMax.x, texelMin.y)),
+        std::max(GetDepth(level, texelMin.x, texelMax.y), GetDepth(level, texelMax.x, texelMax.y)));
+
+    return nearestDepth > farthest;
+}
+
+int SoftwareOcclusion::GetWidth() const {
+    return width;
+}
+
+int SoftwareOcclusion::GetHeight() const {
+    return height;
+}
+
+int SoftwareOcclusion::GetLevelCount() const {
+    return static_cast<int>(levels.size());
+}
+
+float SoftwareOcclusion::GetDepth(int level, int x, int y) const {
+    return levels[level][y * levelSizes[level].x + x];
+}
+
+unsigned int SoftwareOcclusion::GetTriangleCount() const {
+    return triangleCount;
+}
+
+void SoftwareOcclusion::rasterize(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+    // clip against the near plane, z >= -w, which leaves at most a quad
+    const glm::vec4 input[3] = { a, b, c };
+    glm::vec4 polygon[4];
+    int count = 0;
+
+    for (int i = 0; i < 3; i++) {
+        const glm::vec4& current = input[i];
+        const glm::vec4& next = input[(i + 1) % 3];
+        float currentDistance = current.z + current.w;
+        float nextDistance = next.z + next.w;
+
+        if (currentDistance >= 0.0f)
+            polygon[count++] = current;
+        if ((currentDistance >= 0.0f) != (nextDistance >= 0.0f))
+            polygon[count++] = current + (next - current) * (currentDistance / (currentDistance - nextDistance));
+    }
+
+    if (count < 3)
+        return;
+
+    glm::vec3 screen[4];
+    for (int i = 0; i < count; i++) {
+        glm::vec3 ndc = glm::vec3(polygon[i]) / polygon[i].w;
+        screen[i] = glm::vec3((ndc.x * 0.5f + 0.5f) * width, (ndc.y * 0.5f + 0.5f) * height, ndc.z * 0.5f + 0.5f);
+    }
+
+    std::vector<float>& depth = levels[0];
+
+    for (int t = 1; t + 1 < count; t++) {
+        const glm::vec3& v0 = screen[0];
+        const glm::vec3& v1 = screen[t];
+        const glm::vec3& v2 = screen[t + 1];
+
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        if (std::abs(area) < 1e-8f)
+            continue;
+
+        int minX = std::max(static_cast<int>(std::floor(std::min({ v0.x, v1.x, v2.x }))), 0);
+        int maxX = std::min(static_cast<int>(std::ceil(std::max({ v0.x, v1.x, v2.x }))), width - 1);
+        int minY = std::max(static_cast<int>(std::floor(std::min({ v0.y, v1.y, v2.y }))), 0);
+        int maxY = std::min(static_cast<int>(std::ceil(std::max({ v0.y, v1.y, v2.y }))), height - 1);
+        if (minX > maxX || minY > maxY)
+            continue;
+
+        triangleCount++;
+        float inverseArea = 1.0f / area;
+
+        // screen-space barycentrics at texel centers, z/w is affine in screen space
+        for (int y = minY; y <= maxY; y++) {
+            float py = y + 0.5f;
+            for (int x = minX; x <= maxX; x++) {
+                float px = x + 0.5f;
+
+                float w0 = ((v2.x - v1.x) * (py - v1.y) - (v2.y - v1.y) * (px - v1.x)) * inverseArea;
+                float w1 = ((v0.x - v2.x) * (py - v2.y) - (v0.y - v2.y) * (px - v2.x)) * inverseArea;
+                float w2 = 1.0f - w0 - w1;
+                if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+                    continue;
+
+                float z = glm::clamp(w0 * v0.z + w1 * v1.z + w2 * v2.z, 0.0f, 1.0f);
+                float& texel = depth[y * width + x];
+                texel = std::min(texel, z);
+            }
+        }
+    }
+}
+#pragma endregion
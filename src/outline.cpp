@@ -0,0 +1,82 @@
+#include "outline.h"
+
+#pragma region OutlinePass Methods
+OutlinePass::OutlinePass(glm::vec3 color_, int width_) :
+    color(color_), width(width_), emptyVAO(0) {}
+
+
+void OutlinePass::Init() {
+    maskShader = Shader("assets/shaders/unlit/VertexShader.vert", "assets/shaders/unlit/FragmentShader.frag");
+    edgeShader = Shader("assets/shaders/outline/Fullscreen.vert", "assets/shaders/outline/Outline.frag");
+
+    glGenVertexArrays(1, &emptyVAO);
+}
+
+void OutlinePass::Release() {
+    if (emptyVAO == 0)
+        return;
+
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteProgram(maskShader.ID);
+    glDeleteProgram(edgeShader.ID);
+
+    emptyVAO = 0;
+}
+
+void OutlinePass::Clear() {
+    selected.clear();
+}
+
+void OutlinePass::Add(Object3D* object) {
+    if (object != nullptr)
+        selected.push_back(object);
+}
+
+void OutlinePass::Draw(const RenderTarget& mask, const glm::mat4& view, const glm::mat4& projection) {
+    if (selected.empty() || emptyVAO == 0)
+        return;
+
+    GLint targetFBO;
+    GLint viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // mask, whole silhouettes so the outline also shows through occluders
+    glBindFramebuffer(GL_FRAMEBUFFER, mask.FBO);
+    glViewport(0, 0, mask.width, mask.height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_BLEND);
+
+    maskShader.use();
+    maskShader.setMat4("view", view);
+    maskShader.setMat4("projection", projection);
+    maskShader.setVec3("color", glm::vec3(1.0f));
+
+    for (Object3D* object : selected) {
+        object->DrawGeometry(maskShader);
+    }
+
+    // edges
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+    edgeShader.use();
+    edgeShader.setInt("mask", 0);
+    edgeShader.setInt("width", width);
+    edgeShader.setVec3("color", color);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, mask.texture);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glEnable(GL_BLEND);
+    glEnable(GL_DEPTH_TEST);
+}
+
+unsigned int OutlinePass::GetSelectedCount() const {
+    return static_cast<unsigned int>(selected.size());
+}
+#pragma endregion
@@ -0,0 +1,123 @@
+#include "overdraw.h"
+
+#pragma region OverdrawPass Methods
+OverdrawPass::OverdrawPass(float maxCount_) :
+    maxCount(maxCount_), countTexture(0), emptyVAO(0), width(0), height(0),
+    queries{ 0, 0 }, currentQuery(0), queryPending{ false, false }, fragmentCount(0),
+    targetFBO(0), targetViewport{ 0, 0, 0, 0 } {}
+
+void OverdrawPass::Init() {
+    countShader = Shader("assets/shaders/depth/DepthOnly.vert", "assets/shaders/overdraw/Count.frag");
+    countIndirectShader = Shader("assets/shaders/depth/DepthOnlyIndirect.vert", "assets/shaders/overdraw/Count.frag");
+    heatmapShader = Shader("assets/shaders/outline/Fullscreen.vert", "assets/shaders/overdraw/Heatmap.frag");
+
+    glGenVertexArrays(1, &emptyVAO);
+    glGenQueries(2, queries);
+}
+
+void OverdrawPass::Release() {
+    if (emptyVAO == 0)
+        return;
+
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteQueries(2, queries);
+    glDeleteProgram(countShader.ID);
+    glDeleteProgram(countIndirectShader.ID);
+    glDeleteProgram(heatmapShader.ID);
+
+    countTexture = 0;
+    emptyVAO = 0;
+    queries[0] = 0;
+    queries[1] = 0;
+    queryPending[0] = false;
+    queryPending[1] = false;
+    width = 0;
+    height = 0;
+}
+
+void OverdrawPass::BeginQuery() {
+    if (emptyVAO == 0)
+        return;
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    width = viewport[2];
+    height = viewport[3];
+
+    int previous = 1 - currentQuery;
+    if (queryPending[previous]) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[previous], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available) {
+            GLuint64 samples = 0;
+            glGetQueryObjectui64v(queries[previous], GL_QUERY_RESULT, &samples);
+            fragmentCount = samples;
+            queryPending[previous] = false;
+        }
+    }
+
+    glBeginQuery(GL_SAMPLES_PASSED, queries[currentQuery]);
+}
+
+void OverdrawPass::EndQuery() {
+    if (emptyVAO == 0)
+        return;
+
+    glEndQuery(GL_SAMPLES_PASSED);
+    queryPending[currentQuery] = true;
+    currentQuery = 1 - currentQuery;
+}
+
+void OverdrawPass::Begin(const RenderTarget& counts) {
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+
+    countTexture = counts.texture;
+    glBindFramebuffer(GL_FRAMEBUFFER, counts.FBO);
+    glViewport(0, 0, counts.width, counts.height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glDepthMask(GL_TRUE);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+}
+
+void OverdrawPass::End() {
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+
+    heatmapShader.use();
+    heatmapShader.setInt("counts", 0);
+    heatmapShader.setFloat("maxCount", maxCount);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, countTexture);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+}
+
+Shader& OverdrawPass::GetCountShader() {
+    return countShader;
+}
+
+Shader& OverdrawPass::GetCountIndirectShader() {
+    return countIndirectShader;
+}
+
+unsigned long long OverdrawPass::GetFragmentCount() const {
+    return fragmentCount;
+}
+
+unsigned long long OverdrawPass::GetPixelCount() const {
+    return static_cast<unsigned long long>(width) * height;
+}
+#pragma endregion
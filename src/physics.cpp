@@ -0,0 +1,966 @@
+#include "physics.h"
+
+#include <algorithm>
+#include <limits>
+#include <variant>
+
+#pragma region SweepInfo Methods
+SweepInfo::SweepInfo(bool hit_, float toi_, glm::vec3 normal_) :
+    hit(hit_), toi(toi_), normal(normal_) {}
+#pragma endregion
+
+#pragma region Collision Methods
+CollisionInfo checkCollision(const SphereShape& obj1, const SphereShape& obj2) {
+    CollisionInfo info;
+
+    glm::vec3 posDiff = obj1.position - obj2.position;
+    float dist = glm::length(obj1.position - obj2.position);
+    float r = obj1.radius + obj2.radius;
+    if (dist < r) {
+        info.collided = true;
+        info.penetration = r - dist;
+        info.normal = (dist > 0.0f) ? posDiff / dist : glm::vec3(1, 0, 0);
+    }
+
+    return info;
+}
+
+CollisionInfo checkCollision(const SphereShape& obj1, const AABBShape& obj2) {
+    CollisionInfo info;
+
+    glm::vec3 closestPoint = glm::clamp(obj1.position, obj2.min(), obj2.max());
+    glm::vec3 posDiff = obj1.position - closestPoint;
+    float dist = glm::length(posDiff);
+
+    if (dist < obj1.radius) {
+        info.collided = true;
+        info.penetration = obj1.radius - dist;
+        info.normal = (dist > 0.0f) ? posDiff / dist : glm::vec3(1, 0, 0);
+    }
+
+    return info;
+}
+
+CollisionInfo checkCollision(const AABBShape& obj1, const SphereShape& obj2) {
+    CollisionInfo info = checkCollision(obj2, obj1);
+    info.normal = -info.normal;
+
+    return info;
+}
+
+CollisionInfo checkCollision(const AABBShape& obj1, const AABBShape& obj2) {
+    CollisionInfo info;
+
+    glm::vec3 minA = obj1.min();
+    glm::vec3 minB = obj2.min();
+    glm::vec3 maxA = obj1.max();
+    glm::vec3 maxB = obj2.max();
+
+    if ((minA.x <= maxB.x && maxA.x >= minB.x) &&
+        (minA.y <= maxB.y && maxA.y >= minB.y) &&
+        (minA.z <= maxB.z && maxA.z >= minB.z))
+    {
+        info.collided = true;
+
+        float overlapX = std::min(maxA.x, maxB.x) - std::max(minA.x, minB.x);
+        float overlapY = std::min(maxA.y, maxB.y) - std::max(minA.y, minB.y);
+        float overlapZ = std::min(maxA.z, maxB.z) - std::max(minA.z, minB.z);
+
+        if (overlapX < overlapY && overlapX < overlapZ) {
+            info.penetration = overlapX;
+            info.normal = (obj1.position.x < obj2.position.x) ? glm::vec3(-1, 0, 0) : glm::vec3(1, 0, 0);
+        }
+        else if (overlapY < overlapZ) {
+            info.penetration = overlapY;
+            info.normal = (obj1.position.y < obj2.position.y) ? glm::vec3(0, -1, 0) : glm::vec3(0, 1, 0);
+        }
+        else {
+            info.penetration = overlapZ;
+            info.normal = (obj1.position.z < obj2.position.z) ? glm::vec3(0, 0, -1) : glm::vec3(0, 0, 1);
+        }
+    }
+
+    return info;
+}
+
+CollisionInfo checkCollisions(const Rigidbody& obj1, const Rigidbody& obj2) {
+    CollisionInfo info;
+
+    if (!obj1.canCollide || !obj2.canCollide)
+        return info;
+
+    return std::visit([](auto&& s1, auto&& s2) { return checkCollision(s1, s2); }, obj1.shape, obj2.shape);
+}
+#pragma endregion
+
+#pragma region Sweep Methods
+bool raycastAABB(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& boxMin, const glm::vec3& boxMax,
+    float maxT, float& tHit, glm::vec3& normal)
+{
+    float tMin = 0.0f;
+    float tMax = maxT;
+    int hitAxis = -1;
+    float hitSign = 0.0f;
+
+    for (int i = 0; i < 3; i++) {
+        if (std::abs(direction[i]) < 1e-8f) {
+            if (origin[i] < boxMin[i] || origin[i] > boxMax[i])
+                return false;
+            continue;
+        }
+
+        float invDir = 1.0f / direction[i];
+        float t1 = (boxMin[i] - origin[i]) * invDir;
+        float t2 = (boxMax[i] - origin[i]) * invDir;
+        float sign = -1.0f; // entering through the min face
+
+        if (t1 > t2) {
+            std::swap(t1, t2);
+            sign = 1.0f;
+        }
+
+        if (t1 > tMin) {
+            tMin = t1;
+            hitAxis = i;
+            hitSign = sign;
+        }
+        tMax = std::min(tMax, t2);
+
+        if (tMin > tMax)
+            return false;
+    }
+
+    // origin inside the box
+    if (hitAxis == -1)
+        return false;
+
+    tHit = tMin;
+    normal = glm::vec3(0.0f);
+    normal[hitAxis] = hitSign;
+
+    return true;
+}
+
+SweepInfo sweepSphere(const SphereShape& s, const glm::vec3& displacement, const SphereShape& other,
+    const glm::vec3& otherDisplacement)
+{
+    glm::vec3 d = displacement - otherDisplacement;
+    glm::vec3 m = s.position - other.position;
+    float r = s.radius + other.radius;
+
+    float c = glm::dot(m, m) - r * r;
+    if (c < 0.0f)
+        return SweepInfo();
+
+    float a = glm::dot(d, d);
+    float b = glm::dot(m, d);
+    if (a < 1e-12f || b >= 0.0f)
+        return SweepInfo();
+
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f)
+        return SweepInfo();
+
+    float t = (-b - std::sqrt(discriminant)) / a;
+    if (t > 1.0f)
+        return SweepInfo();
+
+    t = std::max(t, 0.0f);
+    return SweepInfo(true, t, glm::normalize(m + d * t));
+}
+
+SweepInfo sweepSphere(const SphereShape& s, const glm::vec3& displacement, const AABBShape& other) {
+    if (checkCollision(s, other).collided)
+        return SweepInfo();
+
+    // Ray against the box grown by the radius. Rounded edges and corners are
+    // treated as sharp, which only makes the hit slightly early.
+    glm::vec3 inflate = glm::vec3(s.radius);
+
+    float t;
+    glm::vec3 normal;
+    if (!raycastAABB(s.position, displacement, other.min() - inflate, other.max() + inflate, 1.0f, t, normal))
+        return SweepInfo();
+
+    return SweepInfo(true, t, normal);
+}
+
+bool raycastSphere(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& center, float radius,
+    float maxT, float& tHit, glm::vec3& normal)
+{
+    glm::vec3 m = origin - center;
+    float b = glm::dot(m, direction);
+    float c = glm::dot(m, m) - radius * radius;
+
+    // outside and pointing away
+    if (c > 0.0f && b > 0.0f)
+        return false;
+
+    float discriminant = b * b - c;
+    if (discriminant < 0.0f)
+        return false;
+
+    // origin inside the sphere counts as a miss, like raycastAABB
+    float t = -b - std::sqrt(discriminant);
+    if (t < 0.0f || t > maxT)
+        return false;
+
+    tHit = t;
+    normal = glm::normalize(m + direction * t);
+
+    return true;
+}
+
+// direction has to be normalized for the sphere case
+bool raycastBody(const Rigidbody& body, const glm::vec3& origin, const glm::vec3& direction,
+    float maxT, float& tHit, glm::vec3& normal)
+{
+    if (const SphereShape* sphere = std::get_if<SphereShape>(&body.shape))
+        return raycastSphere(origin, direction, sphere->position, sphere->radius, maxT, tHit, normal);
+
+    const AABBShape& box = std::get<AABBShape>(body.shape);
+    return raycastAABB(origin, direction, box.min(), box.max(), maxT, tHit, normal);
+}
+
+SweepInfo sweepSphere(const SphereShape& s, const glm::vec3& displacement, const Rigidbody& other) {
+    if (!other.canCollide)
+        return SweepInfo();
+
+    return std::visit([&s, &displacement](auto&& shape) { return sweepSphere(s, displacement, shape); }, other.shape);
+}
+#pragma endregion
+
+#pragma region Resolution Methods
+void computeBounds(const Rigidbody& body, glm::vec3& boundsMin, glm::vec3& boundsMax) {
+    std::visit([&boundsMin, &boundsMax](auto&& shape) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(shape)>, SphereShape>) {
+            boundsMin = shape.position - glm::vec3(shape.radius);
+            boundsMax = shape.position + glm::vec3(shape.radius);
+        }
+        else {
+            boundsMin = shape.min();
+            boundsMax = shape.max();
+        }
+        }, body.shape);
+}
+
+// sleeping bodies behave like static ones until something wakes them
+float inverseMass(const Rigidbody& body) {
+    if (body.behavior != ObjectType::DYNAMIC || body.sleeping || body.mass <= 0.0f)
+        return 0.0f;
+
+    return 1.0f / body.mass;
+}
+
+void resolveCollision(Rigidbody& A, Rigidbody& B, const CollisionInfo& info) {
+    if (!info.collided) return;
+
+    if (A.behavior != ObjectType::DYNAMIC && B.behavior != ObjectType::DYNAMIC)
+        return;
+
+    glm::vec3 normal = glm::normalize(info.normal);
+
+    glm::vec3 relativeVelocity = A.velocity - B.velocity;
+
+    float velAlongNormal = glm::dot(relativeVelocity, normal);
+
+    if (velAlongNormal > 0.0f) return;
+
+    float restitution = std::min(A.restitution, B.restitution);
+
+    float invMassA = inverseMass(A);
+    float invMassB = inverseMass(B);
+
+    if (invMassA + invMassB <= 0.0f)
+        return;
+
+    float j = -(1.0f + restitution) * velAlongNormal;
+    j /= (invMassA + invMassB);
+
+    glm::vec3 impulse = j * normal;
+
+    A.velocity += (impulse * invMassA);
+    B.velocity -= (impulse * invMassB);
+
+    const float percent = 0.2f;
+    const float slop = 0.01f;
+
+    glm::vec3 correction = (std::max(info.penetration - slop, 0.0f) / (invMassA + invMassB)) * percent * normal;
+
+    if (invMassA > 0.0f)
+        A.SetPosition(A.GetPosition() + invMassA * correction);
+    if (invMassB > 0.0f)
+        B.SetPosition(B.GetPosition() - invMassB * correction);
+}
+#pragma endregion
+
+#pragma region PhysicsWorld Methods
+PhysicsWorld::PhysicsWorld(glm::vec3 gravity_, float ccdThreshold_, int maxSubsteps_) :
+    gravity(gravity_), ccdThreshold(ccdThreshold_), maxSubsteps(maxSubsteps_),
+    velocityIterations(8), warmStarting(true), restitutionVelocity(0.001f), correctionPercent(0.2f), correctionSlop(0.01f),
+    allowSleeping(true), sleepVelocity(0.002f), timeToSleep(0.5f),
+    ccdCount(0), sleepingCount(0), proxiesDirty(true),
+    dynamicMovedCount(0), dynamicTreeDirty(true), dynamicTreeBuildArea(0.0f),
+    warmStartedCount(0), nextSleepIsland(0) {}
+
+void PhysicsWorld::Add(Rigidbody* body) {
+    if (std::find(bodies.begin(), bodies.end(), body) != bodies.end())
+        return;
+
+    bodies.push_back(body);
+    sleepIsland.push_back(-1);
+    proxiesDirty = true;
+}
+
+void PhysicsWorld::Remove(Rigidbody* body) {
+    auto it = std::find(bodies.begin(), bodies.end(), body);
+    if (it == bodies.end())
+        return;
+
+    sleepIsland.erase(sleepIsland.begin() + (it - bodies.begin()));
+    bodies.erase(it);
+    proxiesDirty = true;
+
+    // cached contacts are keyed by body index
+    contactCache.clear();
+}
+
+void PhysicsWorld::Step(float deltaTime) {
+    for (unsigned int i = 0; i < bodies.size(); i++) {
+        Rigidbody* body = bodies[i];
+        if (body->behavior != ObjectType::DYNAMIC)
+            continue;
+
+        // woken from outside, e.g. by ApplyForce
+        if (!body->sleeping && sleepIsland[i] != -1)
+            wakeIsland(i);
+
+        if (!body->sleeping)
+            body->ApplyForce(gravity);
+    }
+
+    updateBroadphase();
+    findPairs();
+
+    islandParent.resize(bodies.size());
+    for (unsigned int i = 0; i < bodies.size(); i++) {
+        islandParent[i] = i;
+    }
+
+    contacts.clear();
+    for (const auto& [i, j] : pairs) {
+        Rigidbody& A = *bodies[i];
+        Rigidbody& B = *bodies[j];
+
+        CollisionInfo info = checkCollisions(A, B);
+        if (!info.collided)
+            continue;
+
+        if (A.sleeping && isMoving(j))
+            wakeIsland(i);
+        if (B.sleeping && isMoving(i))
+            wakeIsland(j);
+
+        if (onCollision)
+            onCollision(A, B, info);
+
+        addContact(i, j, info);
+
+        if (A.behavior == ObjectType::DYNAMIC && B.behavior == ObjectType::DYNAMIC && !A.sleeping && !B.sleeping)
+            unionIslands(i, j);
+    }
+
+    for (Rigidbody* body : bodies) {
+        if (!body->sleeping)
+            body->IntegrateVelocity(deltaTime);
+    }
+
+    prepareContacts();
+    solveVelocities();
+    storeImpulses();
+
+    ccdCount = 0;
+    for (unsigned int i = 0; i < bodies.size(); i++) {
+        Rigidbody* body = bodies[i];
+        if (body->behavior != ObjectType::DYNAMIC || body->sleeping)
+            continue;
+
+        if (!dynamicMoved[i]) {
+            dynamicMoved[i] = 1;
+            dynamicMovedCount++;
+        }
+
+        body->ccd = needsCCD(*body, body->velocity);
+
+        if (body->ccd) {
+            integrateSwept(*body);
+            ccdCount++;
+        }
+        else {
+            body->IntegratePosition();
+        }
+    }
+
+    correctPositions();
+    updateSleeping(deltaTime);
+}
+
+void PhysicsWorld::WakeIsland(Rigidbody* body) {
+    auto it = std::find(bodies.begin(), bodies.end(), body);
+    if (it != bodies.end())
+        wakeIsland(static_cast<int>(it - bodies.begin()));
+}
+
+const std::vector<Rigidbody*>& PhysicsWorld::GetBodies() const {
+    return bodies;
+}
+
+unsigned int PhysicsWorld::GetCCDCount() const {
+    return ccdCount;
+}
+
+unsigned int PhysicsWorld::GetSleepingCount() const {
+    return sleepingCount;
+}
+
+unsigned int PhysicsWorld::GetPairCount() const {
+    return static_cast<unsigned int>(pairs.size());
+}
+
+unsigned int PhysicsWorld::GetContactCount() const {
+    return static_cast<unsigned int>(contacts.size());
+}
+
+unsigned int PhysicsWorld::GetWarmStartedCount() const {
+    return warmStartedCount;
+}
+
+const BVH& PhysicsWorld::GetStaticTree() const {
+    return staticTree;
+}
+
+const BVH& PhysicsWorld::GetDynamicTree() const {
+    return dynamicTree;
+}
+
+bool PhysicsWorld::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, RaycastHit& hit) {
+    updateDynamicTree();
+
+    glm::vec3 dir = glm::normalize(direction);
+    float closest = maxDistance;
+    hit.body = nullptr;
+
+    staticTree.Raycast(origin, dir, closest, [this, &origin, &dir, &hit](int item, float& maxT) {
+        float t;
+        glm::vec3 normal;
+        if (!raycastBody(*bodies[staticBodies[item]], origin, dir, maxT, t, normal))
+            return false;
+
+        maxT = t;
+        hit.body = bodies[staticBodies[item]];
+        hit.normal = normal;
+        return true;
+        });
+
+    // the static hit already shortened the ray, so most dynamic subtrees are skipped
+    dynamicTree.Raycast(origin, dir, closest, [this, &origin, &dir, &hit](int item, float& maxT) {
+        float t;
+        glm::vec3 normal;
+        if (!raycastBody(*bodies[dynamicBodies[item]], origin, dir, maxT, t, normal))
+            return false;
+
+        maxT = t;
+        hit.body = bodies[dynamicBodies[item]];
+        hit.normal = normal;
+        return true;
+        });
+
+    if (hit.body == nullptr)
+        return false;
+
+    hit.distance = closest;
+    hit.point = origin + dir * closest;
+    return true;
+}
+
+void PhysicsWorld::OverlapSphere(const glm::vec3& center, float radius, std::vector<Rigidbody*>& results) {
+    updateDynamicTree();
+
+    SphereShape sphere(center, radius);
+    auto test = [&sphere, &results](Rigidbody* body) {
+        if (std::visit([&sphere](auto&& shape) { return checkCollision(sphere, shape); }, body->shape).collided)
+            results.push_back(body);
+    };
+
+    queryResults.clear();
+    staticTree.QuerySphere(center, radius, queryResults);
+    for (int item : queryResults) {
+        test(bodies[staticBodies[item]]);
+    }
+
+    queryResults.clear();
+    dynamicTree.QuerySphere(center, radius, queryResults);
+    for (int item : queryResults) {
+        test(bodies[dynamicBodies[item]]);
+    }
+}
+
+void PhysicsWorld::OverlapAABB(const glm::vec3& min, const glm::vec3& max, std::vector<Rigidbody*>& results) {
+    updateDynamicTree();
+
+    AABBShape box((min + max) * 0.5f, max - min);
+    auto test = [&box, &results](Rigidbody* body) {
+        if (std::visit([&box](auto&& shape) { return checkCollision(box, shape); }, body->shape).collided)
+            results.push_back(body);
+    };
+
+    queryResults.clear();
+    staticTree.QueryAABB(min, max, queryResults);
+    for (int item : queryResults) {
+        test(bodies[staticBodies[item]]);
+    }
+
+    queryResults.clear();
+    dynamicTree.QueryAABB(min, max, queryResults);
+    for (int item : queryResults) {
+        test(bodies[dynamicBodies[item]]);
+    }
+}
+
+void PhysicsWorld::rebuildBroadphase() {
+    proxies.clear();
+    staticBodies.clear();
+    kinematicItems.clear();
+    staticMin.clear();
+    staticMax.clear();
+    kinematicMoved.assign(bodies.size(), 0);
+
+    for (unsigned int i = 0; i < bodies.size(); i++) {
+        glm::vec3 boundsMin, boundsMax;
+        computeBounds(*bodies[i], boundsMin, boundsMax);
+
+        if (bodies[i]->behavior == ObjectType::DYNAMIC) {
+            proxies.push_back({ boundsMin, boundsMax, static_cast<int>(i) });
+            continue;
+        }
+
+        if (bodies[i]->behavior == ObjectType::KINEMATIC)
+            kinematicItems.push_back(static_cast<int>(staticBodies.size()));
+
+        staticBodies.push_back(i);
+        staticMin.push_back(boundsMin);
+        staticMax.push_back(boundsMax);
+    }
+
+    staticTree.Build(staticMin, staticMax);
+    proxiesDirty = false;
+
+    dynamicMoved.assign(bodies.size(), 0);
+    dynamicMovedCount = 0;
+    dynamicTreeDirty = true;
+}
+
+void PhysicsWorld::updateBroadphase() {
+    if (proxiesDirty) {
+        rebuildBroadphase();
+    }
+    else {
+        for (BroadphaseProxy& proxy : proxies) {
+            if (!bodies[proxy.body]->sleeping)
+                computeBounds(*bodies[proxy.body], proxy.min, proxy.max);
+        }
+
+        for (int item : kinematicItems) {
+            int body = staticBodies[item];
+
+            glm::vec3 boundsMin, boundsMax;
+            computeBounds(*bodies[body], boundsMin, boundsMax);
+
+            kinematicMoved[body] = (boundsMin != staticMin[item] || boundsMax != staticMax[item]);
+            if (!kinematicMoved[body])
+                continue;
+
+            staticMin[item] = boundsMin;
+            staticMax[item] = boundsMax;
+            staticTree.UpdateItem(item, boundsMin, boundsMax);
+        }
+    }
+
+    // insertion sort, the order barely changes between steps
+    for (unsigned int i = 1; i < proxies.size(); i++) {
+        BroadphaseProxy proxy = proxies[i];
+        unsigned int j = i;
+
+        while (j > 0 && proxies[j - 1].min.x > proxy.min.x) {
+            proxies[j] = proxies[j - 1];
+            j--;
+        }
+        proxies[j] = proxy;
+    }
+}
+
+// Only bodies that were awake during a step since the last query are refit,
+// so picking in a mostly resting scene costs a few hundred node updates at most.
+// Refitting loosens the tree as bodies spread out, it is rebuilt once the root
+// has grown to twice the area it was built with.
+void PhysicsWorld::updateDynamicTree() {
+    if (proxiesDirty)
+        rebuildBroadphase();
+
+    if (!dynamicTreeDirty && dynamicMovedCount > 0) {
+        // past an eighth of the items one linear refit beats walking up from every leaf
+        bool fullRefit = dynamicMovedCount * 8 > dynamicBodies.size();
+
+        for (unsigned int item = 0; item < dynamicBodies.size(); item++) {
+            int body = dynamicBodies[item];
+            if (!dynamicMoved[body])
+                continue;
+
+            glm::vec3 boundsMin, boundsMax;
+            computeBounds(*bodies[body], boundsMin, boundsMax);
+            if (fullRefit)
+                dynamicTree.SetItem(item, boundsMin, boundsMax);
+            else
+                dynamicTree.UpdateItem(item, boundsMin, boundsMax);
+        }
+
+        if (fullRefit)
+            dynamicTree.Refit();
+
+        if (dynamicTree.GetRootArea() > dynamicTreeBuildArea * 2.0f)
+            dynamicTreeDirty = true;
+    }
+
+    std::fill(dynamicMoved.begin(), dynamicMoved.end(), 0);
+    dynamicMovedCount = 0;
+
+    if (!dynamicTreeDirty)
+        return;
+
+    std::vector<glm::vec3> mins(proxies.size());
+    std::vector<glm::vec3> maxs(proxies.size());
+    dynamicBodies.resize(proxies.size());
+
+    for (unsigned int item = 0; item < proxies.size(); item++) {
+        int body = proxies[item].body;
+        dynamicBodies[item] = body;
+        computeBounds(*bodies[body], mins[item], maxs[item]);
+    }
+
+    dynamicTree.Build(mins, maxs);
+    dynamicTreeBuildArea = dynamicTree.GetRootArea();
+    dynamicTreeDirty = false;
+}
+
+void PhysicsWorld::findPairs() {
+    pairs.clear();
+
+    // dynamic against dynamic
+    for (unsigned int i = 0; i < proxies.size(); i++) {
+        const BroadphaseProxy& a = proxies[i];
+
+        for (unsigned int j = i + 1; j < proxies.size() && proxies[j].min.x <= a.max.x; j++) {
+            const BroadphaseProxy& b = proxies[j];
+
+            if (a.max.y < b.min.y || a.min.y > b.max.y || a.max.z < b.min.z || a.min.z > b.max.z)
+                continue;
+
+            if (!isActive(a.body) && !isActive(b.body))
+                continue;
+
+            pairs.emplace_back(std::min(a.body, b.body), std::max(a.body, b.body));
+        }
+    }
+
+    // awake dynamic against static and kinematic
+    for (const BroadphaseProxy& proxy : proxies) {
+        if (bodies[proxy.body]->sleeping)
+            continue;
+
+        queryResults.clear();
+        staticTree.QueryAABB(proxy.min, proxy.max, queryResults);
+
+        for (int item : queryResults) {
+            int other = staticBodies[item];
+            pairs.emplace_back(std::min(proxy.body, other), std::max(proxy.body, other));
+        }
+    }
+
+    // a moving kinematic body still has to find the sleeping bodies it pushes into
+    for (int item : kinematicItems) {
+        int kinematic = staticBodies[item];
+        if (!kinematicMoved[kinematic])
+            continue;
+
+        const glm::vec3& min = staticMin[item];
+        const glm::vec3& max = staticMax[item];
+
+        for (const BroadphaseProxy& proxy : proxies) {
+            if (proxy.min.x > max.x)
+                break;
+
+            if (!bodies[proxy.body]->sleeping || proxy.max.x < min.x ||
+                proxy.max.y < min.y || proxy.min.y > max.y || proxy.max.z < min.z || proxy.min.z > max.z)
+                continue;
+
+            pairs.emplace_back(std::min(proxy.body, kinematic), std::max(proxy.body, kinematic));
+        }
+    }
+}
+
+void PhysicsWorld::addContact(int i, int j, const CollisionInfo& info) {
+    ContactConstraint contact;
+    contact.bodyA = i;
+    contact.bodyB = j;
+    contact.normal = glm::normalize(info.normal);
+    contact.penetration = info.penetration;
+    contact.invMassA = inverseMass(*bodies[i]);
+    contact.invMassB = inverseMass(*bodies[j]);
+
+    if (contact.invMassA + contact.invMassB <= 0.0f)
+        return;
+
+    contact.normalMass = 1.0f / (contact.invMassA + contact.invMassB);
+    contact.velocityBias = 0.0f;
+    contact.normalImpulse = 0.0f;
+
+    contacts.push_back(contact);
+}
+
+static uint64_t contactKey(int a, int b) {
+    return (static_cast<uint64_t>(a) << 32) | static_cast<uint32_t>(b);
+}
+
+// Restitution is taken from the approach speed before any impulse is applied,
+// then last step's accumulated impulse is applied up front if the normal still matches.
+void PhysicsWorld::prepareContacts() {
+    warmStartedCount = 0;
+
+    for (ContactConstraint& contact : contacts) {
+        Rigidbody& A = *bodies[contact.bodyA];
+        Rigidbody& B = *bodies[contact.bodyB];
+
+        float velAlongNormal = glm::dot(A.velocity - B.velocity, contact.normal);
+        if (velAlongNormal < -restitutionVelocity)
+            contact.velocityBias = -std::min(A.restitution, B.restitution) * velAlongNormal;
+
+        if (!warmStarting)
+            continue;
+
+        auto cached = contactCache.find(contactKey(contact.bodyA, contact.bodyB));
+        if (cached == contactCache.end() || glm::dot(cached->second.normal, contact.normal) < 0.95f)
+            continue;
+
+        contact.normalImpulse = cached->second.normalImpulse;
+        glm::vec3 impulse = contact.normalImpulse * contact.normal;
+        A.velocity += impulse * contact.invMassA;
+        B.velocity -= impulse * contact.invMassB;
+
+        warmStartedCount++;
+    }
+}
+
+void PhysicsWorld::solveVelocities() {
+    for (int iteration = 0; iteration < velocityIterations; iteration++) {
+        for (ContactConstraint& contact : contacts) {
+            Rigidbody& A = *bodies[contact.bodyA];
+            Rigidbody& B = *bodies[contact.bodyB];
+
+            float velAlongNormal = glm::dot(A.velocity - B.velocity, contact.normal);
+            float lambda = -contact.normalMass * (velAlongNormal - contact.velocityBias);
+
+            // clamp the accumulated impulse, not the increment, so contacts can only push
+            float previous = contact.normalImpulse;
+            contact.normalImpulse = std::max(previous + lambda, 0.0f);
+            lambda = contact.normalImpulse - previous;
+
+            glm::vec3 impulse = lambda * contact.normal;
+            A.velocity += impulse * contact.invMassA;
+            B.velocity -= impulse * contact.invMassB;
+        }
+    }
+}
+
+void PhysicsWorld::correctPositions() {
+    for (const ContactConstraint& contact : contacts) {
+        Rigidbody& A = *bodies[contact.bodyA];
+        Rigidbody& B = *bodies[contact.bodyB];
+
+        glm::vec3 correction = std::max(contact.penetration - correctionSlop, 0.0f) * contact.normalMass * correctionPercent * contact.normal;
+
+        if (contact.invMassA > 0.0f)
+            A.SetPosition(A.GetPosition() + contact.invMassA * correction);
+        if (contact.invMassB > 0.0f)
+            B.SetPosition(B.GetPosition() - contact.invMassB * correction);
+    }
+}
+
+void PhysicsWorld::storeImpulses() {
+    contactCache.clear();
+
+    for (const ContactConstraint& contact : contacts) {
+        contactCache[contactKey(contact.bodyA, contact.bodyB)] = { contact.normal, contact.normalImpulse };
+    }
+}
+
+int PhysicsWorld::findIsland(int i) {
+    while (islandParent[i] != i) {
+        islandParent[i] = islandParent[islandParent[i]];
+        i = islandParent[i];
+    }
+
+    return i;
+}
+
+void PhysicsWorld::unionIslands(int a, int b) {
+    a = findIsland(a);
+    b = findIsland(b);
+
+    if (a != b)
+        islandParent[std::max(a, b)] = std::min(a, b);
+}
+
+// An island only sleeps once every body in it has been resting for timeToSleep.
+void PhysicsWorld::updateSleeping(float deltaTime) {
+    sleepingCount = 0;
+
+    if (!allowSleeping) {
+        for (unsigned int i = 0; i < bodies.size(); i++) {
+            if (bodies[i]->sleeping)
+                wakeIsland(i);
+        }
+        return;
+    }
+
+    islandTimer.assign(bodies.size(), std::numeric_limits<float>::max());
+    islandSleepId.assign(bodies.size(), -1);
+
+    for (unsigned int i = 0; i < bodies.size(); i++) {
+        Rigidbody& body = *bodies[i];
+        if (body.behavior != ObjectType::DYNAMIC || body.sleeping)
+            continue;
+
+        if (glm::dot(body.velocity, body.velocity) > sleepVelocity * sleepVelocity)
+            body.sleepTimer = 0.0f;
+        else
+            body.sleepTimer += deltaTime;
+
+        int island = findIsland(i);
+        islandTimer[island] = std::min(islandTimer[island], body.sleepTimer);
+    }
+
+    for (unsigned int i = 0; i < bodies.size(); i++) {
+        Rigidbody& body = *bodies[i];
+        if (body.behavior != ObjectType::DYNAMIC)
+            continue;
+
+        if (!body.sleeping) {
+            int island = findIsland(i);
+            if (islandTimer[island] < timeToSleep)
+                continue;
+
+            if (islandSleepId[island] == -1)
+                islandSleepId[island] = nextSleepIsland++;
+
+            body.Sleep();
+            sleepIsland[i] = islandSleepId[island];
+        }
+
+        sleepingCount++;
+    }
+}
+
+void PhysicsWorld::wakeIsland(int i) {
+    int island = sleepIsland[i];
+    bodies[i]->Wake();
+    sleepIsland[i] = -1;
+
+    if (island == -1)
+        return;
+
+    for (unsigned int j = 0; j < bodies.size(); j++) {
+        if (sleepIsland[j] == island) {
+            bodies[j]->Wake();
+            sleepIsland[j] = -1;
+        }
+    }
+}
+
+bool PhysicsWorld::isActive(int i) const {
+    const Rigidbody& body = *bodies[i];
+    return body.behavior == ObjectType::KINEMATIC || (body.behavior == ObjectType::DYNAMIC && !body.sleeping);
+}
+
+bool PhysicsWorld::isMoving(int i) const {
+    const Rigidbody& body = *bodies[i];
+
+    if (body.behavior == ObjectType::KINEMATIC)
+        return kinematicMoved[i] != 0;
+
+    return body.behavior == ObjectType::DYNAMIC && !body.sleeping &&
+        glm::dot(body.velocity, body.velocity) > sleepVelocity * sleepVelocity;
+}
+
+bool PhysicsWorld::needsCCD(const Rigidbody& body, const glm::vec3& displacement) const {
+    if (!body.canCollide || !std::holds_alternative<SphereShape>(body.shape))
+        return false;
+
+    float radius = std::get<SphereShape>(body.shape).radius;
+    return glm::dot(displacement, displacement) > (ccdThreshold * radius) * (ccdThreshold * radius);
+}
+
+// Moves the body to its earliest time of impact, resolves that contact and spends
+// the rest of the step along the new velocity, up to maxSubsteps times.
+// Other bodies are treated as stationary at their current positions.
+void PhysicsWorld::integrateSwept(Rigidbody& body) {
+    float remaining = 1.0f;
+    for (int substep = 0; substep < maxSubsteps && remaining > 0.0f; substep++) {
+        glm::vec3 displacement = body.velocity * remaining;
+        const SphereShape& sphere = std::get<SphereShape>(body.shape);
+
+        glm::vec3 sweptMin = glm::min(sphere.position, sphere.position + displacement) - glm::vec3(sphere.radius);
+        glm::vec3 sweptMax = glm::max(sphere.position, sphere.position + displacement) + glm::vec3(sphere.radius);
+
+        SweepInfo earliest;
+        Rigidbody* other = nullptr;
+        auto sweepAgainst = [&](Rigidbody* candidate) {
+            SweepInfo sweep = sweepSphere(sphere, displacement, *candidate);
+            if (sweep.hit && sweep.toi < earliest.toi) {
+                earliest = sweep;
+                other = candidate;
+            }
+        };
+
+        queryResults.clear();
+        staticTree.QueryAABB(sweptMin, sweptMax, queryResults);
+        for (int item : queryResults) {
+            sweepAgainst(bodies[staticBodies[item]]);
+        }
+
+        for (const BroadphaseProxy& proxy : proxies) {
+            if (proxy.min.x > sweptMax.x)
+                break;
+
+            if (bodies[proxy.body] == &body || proxy.max.x < sweptMin.x ||
+                proxy.max.y < sweptMin.y || proxy.min.y > sweptMax.y || proxy.max.z < sweptMin.z || proxy.min.z > sweptMax.z)
+                continue;
+
+            sweepAgainst(bodies[proxy.body]);
+        }
+
+        if (other == nullptr) {
+            body.SetPosition(body.GetPosition() + displacement);
+            return;
+        }
+
+        body.SetPosition(body.GetPosition() + displacement * earliest.toi);
+
+        CollisionInfo info(true, earliest.normal, 0.0f);
+        if (onCollision)
+            onCollision(body, *other, info);
+        resolveCollision(body, *other, info);
+
+        remaining *= 1.0f - earliest.toi;
+    }
+}
+#pragma endregion
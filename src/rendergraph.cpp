@@ -0,0 +1,237 @@
+#include "rendergraph.h"
+
+#include <iostream>
+
+// Bits a pass needs before accessing what an earlier pass left behind incoherently.
+static GLbitfield barrierBits(RenderGraph::Access access) {
+    switch (access) {
+    case RenderGraph::ACCESS_ATTACHMENT:
+        return GL_FRAMEBUFFER_BARRIER_BIT;
+    case RenderGraph::ACCESS_SAMPLED:
+        return GL_TEXTURE_FETCH_BARRIER_BIT;
+    case RenderGraph::ACCESS_IMAGE:
+        return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+    case RenderGraph::ACCESS_STORAGE:
+        return GL_SHADER_STORAGE_BARRIER_BIT;
+    case RenderGraph::ACCESS_INDIRECT:
+        return GL_COMMAND_BARRIER_BIT;
+    case RenderGraph::ACCESS_UNIFORM:
+        return GL_UNIFORM_BARRIER_BIT;
+    case RenderGraph::ACCESS_TRANSFER:
+        return GL_FRAMEBUFFER_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT;
+    }
+    return 0;
+}
+
+#pragma region RenderGraph Methods
+RenderGraph::RenderGraph() : importedCount(0), culledCount(0), barrierCount(0) {}
+
+void RenderGraph::Release() {
+    pool.Release();
+}
+
+int RenderGraph::Import(const char* name) {
+    // transients sit after the imported resources and would shift
+    if (resources.size() != importedCount) {
+        std::cout << "ERROR::RENDER_GRAPH::IMPORT_AFTER_TRANSIENT " << name << std::endl;
+        return -1;
+    }
+
+    Resource resource = {};
+    resource.name = name;
+    resource.imported = true;
+    resource.firstPass = -1;
+    resource.lastPass = -1;
+    resources.push_back(resource);
+    return static_cast<int>(importedCount++);
+}
+
+void RenderGraph::SetOutput(int resource, bool output) {
+    resources[resource].output = output;
+}
+
+void RenderGraph::Reset() {
+    resources.resize(importedCount);
+    passes.clear();
+}
+
+int RenderGraph::CreateTarget(const char* name, int width, int height, GLenum format, bool depth) {
+    Resource resource = {};
+    resource.name = name;
+    resource.width = width;
+    resource.height = height;
+    resource.format = format;
+    resource.depth = depth;
+    resource.firstPass = -1;
+    resource.lastPass = -1;
+    resources.push_back(resource);
+    return static_cast<int>(resources.size() - 1);
+}
+
+int RenderGraph::AddPass(const char* name, std::function<void()> execute) {
+    Pass pass;
+    pass.name = name;
+    pass.execute = std::move(execute);
+    pass.culled = false;
+    pass.barriers = 0;
+    passes.push_back(std::move(pass));
+    return static_cast<int>(passes.size() - 1);
+}
+
+void RenderGraph::Read(int pass, int resource, Access access) {
+    if (resource < 0)
+        return;
+    passes[pass].uses.push_back({ resource, access, false });
+}
+
+void RenderGraph::Write(int pass, int resource, Access access) {
+    if (resource < 0)
+        return;
+    passes[pass].uses.push_back({ resource, access, true });
+}
+
+void RenderGraph::Compile() {
+    cull();
+    planBarriers();
+    planLifetimes();
+}
+
+void RenderGraph::Execute() {
+    for (int i = 0; i < static_cast<int>(passes.size()); i++) {
+        Pass& pass = passes[i];
+        if (pass.culled)
+            continue;
+
+        for (unsigned int r = importedCount; r < resources.size(); r++) {
+            Resource& resource = resources[r];
+            if (resource.firstPass == i)
+                resource.target = pool.Acquire(resource.width, resource.height, resource.format, resource.depth);
+        }
+
+        if (pass.barriers != 0)
+            glMemoryBarrier(pass.barriers);
+
+        pass.execute();
+
+        // free right away, a later pass can take the memory over
+        for (unsigned int r = importedCount; r < resources.size(); r++) {
+            Resource& resource = resources[r];
+            if (resource.lastPass == i)
+                pool.Free(resource.target);
+        }
+    }
+
+    pool.EndFrame();
+}
+
+const RenderTarget& RenderGraph::GetTarget(int resource) const {
+    return resources[resource].target;
+}
+
+RenderTargetPool& RenderGraph::GetPool() {
+    return pool;
+}
+
+unsigned int RenderGraph::GetPassCount() const {
+    return static_cast<unsigned int>(passes.size());
+}
+
+const char* RenderGraph::GetPassName(int pass) const {
+    return passes[pass].name.c_str();
+}
+
+bool RenderGraph::IsCulled(int pass) const {
+    return passes[pass].culled;
+}
+
+GLbitfield RenderGraph::GetBarriers(int pass) const {
+    return passes[pass].barriers;
+}
+
+unsigned int RenderGraph::GetCulledCount() const {
+    return culledCount;
+}
+
+unsigned int RenderGraph::GetBarrierCount() const {
+    return barrierCount;
+}
+
+void RenderGraph::cull() {
+    // walking back from the outputs, a pass survives when a later survivor or an output
+    // needs something it writes, and everything it touches is needed in turn
+    std::vector<bool> needed(resources.size());
+    for (unsigned int r = 0; r < resources.size(); r++)
+        needed[r] = resources[r].output;
+
+    culledCount = 0;
+    for (int i = static_cast<int>(passes.size()) - 1; i >= 0; i--) {
+        Pass& pass = passes[i];
+
+        pass.culled = true;
+        for (const Use& use : pass.uses) {
+            if (use.write && needed[use.resource])
+                pass.culled = false;
+        }
+
+        if (pass.culled) {
+            culledCount++;
+            continue;
+        }
+
+        for (const Use& use : pass.uses)
+            needed[use.resource] = true;
+    }
+}
+
+void RenderGraph::planBarriers() {
+    barrierCount = 0;
+    for (Pass& pass : passes) {
+        pass.barriers = 0;
+        if (pass.culled)
+            continue;
+
+        for (const Use& use : pass.uses) {
+            const Resource& resource = resources[use.resource];
+            if (resource.incoherent)
+                pass.barriers |= barrierBits(use.access) & ~resource.issued;
+        }
+
+        // a barrier covers everything written before it, not just what asked for it
+        if (pass.barriers != 0) {
+            barrierCount++;
+            for (Resource& resource : resources)
+                resource.issued |= pass.barriers;
+        }
+
+        for (const Use& use : pass.uses) {
+            Resource& resource = resources[use.resource];
+            if (use.write && (use.access == ACCESS_IMAGE || use.access == ACCESS_STORAGE)) {
+                resource.incoherent = true;
+                resource.issued = 0;
+            }
+        }
+    }
+}
+
+void RenderGraph::planLifetimes() {
+    for (unsigned int r = importedCount; r < resources.size(); r++) {
+        resources[r].firstPass = -1;
+        resources[r].lastPass = -1;
+    }
+
+    for (int i = 0; i < static_cast<int>(passes.size()); i++) {
+        if (passes[i].culled)
+            continue;
+
+        for (const Use& use : passes[i].uses) {
+            Resource& resource = resources[use.resource];
+            if (resource.imported)
+                continue;
+
+            if (resource.firstPass < 0)
+                resource.firstPass = i;
+            resource.lastPass = i;
+        }
+    }
+}
+#pragma endregion
@@ -0,0 +1,111 @@
+#include "rendertargets.h"
+
+#include <iostream>
+
+#pragma region RenderTargetPool Methods
+RenderTargetPool::RenderTargetPool() : frame(0), allocationCount(0) {}
+
+void RenderTargetPool::Release() {
+    for (Entry& entry : entries) {
+        glDeleteFramebuffers(1, &entry.target.FBO);
+        glDeleteTextures(1, &entry.target.texture);
+        if (entry.target.depthTexture != 0)
+            glDeleteTextures(1, &entry.target.depthTexture);
+    }
+    entries.clear();
+}
+
+RenderTarget RenderTargetPool::Acquire(int width, int height, GLenum format, bool depth) {
+    for (Entry& entry : entries) {
+        const RenderTarget& target = entry.target;
+        if (entry.inUse || target.width != width || target.height != height || target.format != format ||
+            (target.depthTexture != 0) != depth)
+            continue;
+
+        entry.inUse = true;
+        entry.lastUsedFrame = frame;
+        return target;
+    }
+
+    Entry entry;
+    entry.target = allocate(width, height, format, depth);
+    entry.inUse = true;
+    entry.lastUsedFrame = frame;
+    entries.push_back(entry);
+    return entry.target;
+}
+
+void RenderTargetPool::Free(const RenderTarget& target) {
+    for (Entry& entry : entries) {
+        if (entry.target.FBO == target.FBO) {
+            entry.inUse = false;
+            return;
+        }
+    }
+}
+
+void RenderTargetPool::EndFrame() {
+    // the driver defers the delete until the GPU is done with the target
+    for (unsigned int i = 0; i < entries.size();) {
+        Entry& entry = entries[i];
+        if (entry.inUse || frame - entry.lastUsedFrame < KEEP_FRAMES) {
+            i++;
+            continue;
+        }
+
+        glDeleteFramebuffers(1, &entry.target.FBO);
+        glDeleteTextures(1, &entry.target.texture);
+        if (entry.target.depthTexture != 0)
+            glDeleteTextures(1, &entry.target.depthTexture);
+
+        entries[i] = entries.back();
+        entries.pop_back();
+    }
+
+    frame++;
+}
+
+unsigned int RenderTargetPool::GetTargetCount() const {
+    return static_cast<unsigned int>(entries.size());
+}
+
+unsigned int RenderTargetPool::GetAllocationCount() const {
+    return allocationCount;
+}
+
+RenderTarget RenderTargetPool::allocate(int width, int height, GLenum format, bool depth) {
+    RenderTarget target = { 0, 0, 0, width, height, format };
+    allocationCount++;
+
+    // targets can be acquired while another one is bound
+    GLint boundFBO;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &boundFBO);
+
+    glGenTextures(1, &target.texture);
+    glBindTexture(GL_TEXTURE_2D, target.texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, format, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    glGenFramebuffers(1, &target.FBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+
+    if (depth) {
+        glGenTextures(1, &target.depthTexture);
+        glBindTexture(GL_TEXTURE_2D, target.depthTexture);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH24_STENCIL8, width, height);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, target.depthTexture, 0);
+    }
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::RENDER_TARGET_POOL::FRAMEBUFFER_INCOMPLETE" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFBO);
+
+    return target;
+}
+#pragma endregion
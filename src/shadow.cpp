@@ -0,0 +1,571 @@
+#include "shadow.h"
+
+#include "streambuffer.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#pragma region CascadedShadowMap Methods
+CascadedShadowMap::CascadedShadowMap(int cascadeCount_, int resolution_) :
+    enabled(true), cascadeCount(cascadeCount_), resolution(resolution_), shadowDistance(60.0f), splitLambda(0.75f),
+    FBO(0), depthTexture(0), modelBuffer(0), streamBuffer(nullptr), allocatedCount(0), allocatedResolution(0),
+    matrices{}, splits{}, texelSizes{}, casterCounts{}, drawCount(0), groupCount(0) {}
+
+void CascadedShadowMap::Init() {
+    depthShader = Shader("assets/shaders/shadow/CascadeDepth.vert", "assets/shaders/depth/DepthOnly.frag");
+
+    glGenFramebuffers(1, &FBO);
+    glGenTextures(1, &depthTexture);
+    glGenBuffers(1, &modelBuffer);
+
+    allocate();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void CascadedShadowMap::Release() {
+    if (FBO == 0)
+        return;
+
+    glDeleteFramebuffers(1, &FBO);
+    glDeleteTextures(1, &depthTexture);
+    glDeleteBuffers(1, &modelBuffer);
+    glDeleteProgram(depthShader.ID);
+
+    FBO = 0;
+    depthTexture = 0;
+    modelBuffer = 0;
+    allocatedCount = 0;
+    allocatedResolution = 0;
+}
+
+void CascadedShadowMap::SetStreamBuffer(StreamBuffer* streamBuffer_) {
+    streamBuffer = streamBuffer_;
+}
+
+void CascadedShadowMap::Render(const DirectionLight& light, const glm::mat4& view, float fovy, float aspect,
+    float zNear, float zFar, const std::vector<Object3D*>& casters) {
+    drawCount = 0;
+    for (unsigned int& count : casterCounts)
+        count = 0;
+
+    if (FBO == 0 || !enabled)
+        return;
+
+    int targetFBO;
+    int targetViewport[4];
+    int depthFunc;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+
+    cascadeCount = std::min(std::max(cascadeCount, 1), MAX_CASCADES);
+    resolution = std::max(resolution, 64);
+    if (cascadeCount != allocatedCount || resolution != allocatedResolution)
+        allocate();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glViewport(0, 0, resolution, resolution);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+
+    // slope-scaled, the normal offset in the lit shaders does the rest
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(2.0f, 4.0f);
+
+    // the light's rotation only, cascades are placed by their projection
+    glm::vec3 direction = glm::normalize(light.direction);
+    glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightView = glm::lookAt(glm::vec3(0.0f), direction, up);
+    glm::mat4 inverseView = glm::inverse(view);
+
+    float farthest = std::min(shadowDistance, zFar);
+    float tanHalf = std::tan(fovy * 0.5f);
+    // squared distance of a frustum corner from the view axis, per unit of depth
+    float cornerSlope = tanHalf * tanHalf * (1.0f + aspect * aspect);
+
+    depthShader.use();
+
+    float sliceNear = zNear;
+    for (int i = 0; i < cascadeCount; i++) {
+        // practical split scheme, blends uniform and logarithmic splits
+        float t = static_cast<float>(i + 1) / cascadeCount;
+        float uniformSplit = zNear + (farthest - zNear) * t;
+        float logSplit = zNear * std::pow(farthest / zNear, t);
+        float sliceFar = uniformSplit + (logSplit - uniformSplit) * splitLambda;
+
+        // smallest sphere through the slice's corners, centered on the view axis.
+        // It only depends on the slice, so the cascade keeps its size as the camera turns.
+        float centerDepth = std::min(0.5f * (sliceNear + sliceFar) * (1.0f + cornerSlope), sliceFar);
+        float radius = std::sqrt(sliceFar * sliceFar * cornerSlope + (sliceFar - centerDepth) * (sliceFar - centerDepth));
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        glm::vec3 center = glm::vec3(inverseView * glm::vec4(0.0f, 0.0f, -centerDepth, 1.0f));
+
+        splits[i] = sliceFar;
+        texelSizes[i] = 2.0f * radius / resolution;
+        renderCascade(i, lightView, center, radius, casters);
+
+        sliceNear = sliceFar;
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glDepthFunc(depthFunc);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+}
+
+void CascadedShadowMap::Apply(Shader& shader, int unit) const {
+    int count = enabled && FBO != 0 ? allocatedCount : 0;
+    shader.setInt("cascadeCount", count);
+    shader.setInt("shadowMap", unit);
+
+    for (int i = 0; i < count; i++) {
+        std::string index = "[" + std::to_string(i) + "]";
+        shader.setMat4("cascadeMatrices" + index, matrices[i]);
+        shader.setFloat("cascadeSplits" + index, splits[i]);
+        shader.setFloat("cascadeTexelSizes" + index, texelSizes[i]);
+    }
+
+    // bound even when off, a shadow sampler must never see an incomplete texture
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+int CascadedShadowMap::GetCascadeCount() const {
+    return allocatedCount;
+}
+
+float CascadedShadowMap::GetSplit(int cascade) const {
+    return splits[cascade];
+}
+
+unsigned int CascadedShadowMap::GetCasterCount(int cascade) const {
+    return casterCounts[cascade];
+}
+
+unsigned int CascadedShadowMap::GetDrawCount() const {
+    return drawCount;
+}
+
+void CascadedShadowMap::allocate() {
+    allocatedCount = cascadeCount;
+    allocatedResolution = resolution;
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, cascadeCount, 0,
+        GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+    // linear filtering with a compare gives 2x2 PCF per tap for free
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+
+    // outside the map is lit
+    float border[] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+    glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, border);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::SHADOW::CASCADE_FRAMEBUFFER_INCOMPLETE" << std::endl;
+}
+
+void CascadedShadowMap::renderCascade(int cascade, const glm::mat4& lightView, const glm::vec3& center, float radius,
+    const std::vector<Object3D*>& casters) {
+    // whole texels only, so casters land on the same texels from frame to frame
+    float texel = texelSizes[cascade];
+    glm::vec3 lightCenter = glm::vec3(lightView * glm::vec4(center, 1.0f));
+    lightCenter.x = std::floor(lightCenter.x / texel) * texel;
+    lightCenter.y = std::floor(lightCenter.y / texel) * texel;
+
+    // the light looks down -z, zMax is the side facing it
+    float zMin = lightCenter.z - radius;
+    float zMax = lightCenter.z + radius;
+
+    for (unsigned int i = 0; i < groupCount; i++)
+        groups[i].models.clear();
+    groupCount = 0;
+
+    for (Object3D* object : casters) {
+        if (!object->drawn)
+            continue;
+
+        glm::vec4 bounds = object->GetBounds();
+        glm::vec3 lightPosition = glm::vec3(lightView * glm::vec4(bounds.x, bounds.y, bounds.z, 1.0f));
+
+        if (std::abs(lightPosition.x - lightCenter.x) > radius + bounds.w ||
+            std::abs(lightPosition.y - lightCenter.y) > radius + bounds.w)
+            continue;
+
+        // entirely past the slice along the light, it shadows nothing in it
+        if (lightPosition.z + bounds.w < zMin)
+            continue;
+
+        // casters between the light and the slice pull the near plane toward the light
+        zMax = std::max(zMax, lightPosition.z + bounds.w);
+        addCaster(*object);
+        casterCounts[cascade]++;
+    }
+
+    glm::mat4 projection = glm::ortho(lightCenter.x - radius, lightCenter.x + radius,
+        lightCenter.y - radius, lightCenter.y + radius, -zMax, -zMin);
+    matrices[cascade] = projection * lightView;
+
+    glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depthTexture, 0, cascade);
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    if (groupCount == 0)
+        return;
+
+    models.clear();
+    for (unsigned int i = 0; i < groupCount; i++)
+        models.insert(models.end(), groups[i].models.begin(), groups[i].models.end());
+
+    unsigned int bytes = static_cast<unsigned int>(models.size() * sizeof(glm::mat4));
+    GLintptr offset = -1;
+    if (streamBuffer != nullptr)
+        offset = streamBuffer->BindStorage(4, models.data(), bytes);
+
+    if (offset < 0) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, modelBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, models.data(), GL_STREAM_DRAW);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, modelBuffer);
+    }
+
+    depthShader.setMat4("lightSpaceMatrix", matrices[cascade]);
+
+    int first = 0;
+    for (unsigned int i = 0; i < groupCount; i++) {
+        CasterGroup& group = groups[i];
+        int count = static_cast<int>(group.models.size());
+
+        depthShader.setInt("baseModel", first);
+        glBindVertexArray(group.VAO);
+
+        if (group.drawElements)
+            glDrawElementsInstanced(GL_TRIANGLES, group.indexCount, group.indexType, 0, count);
+        else
+            glDrawArraysInstanced(GL_TRIANGLES, 0, group.indexCount, count);
+
+        first += count;
+        drawCount++;
+    }
+
+    glBindVertexArray(0);
+}
+
+void CascadedShadowMap::addCaster(Object3D& object) {
+    CasterGroup* group = nullptr;
+    for (unsigned int i = 0; i < groupCount; i++) {
+        CasterGroup& candidate = groups[i];
+        if (candidate.VAO == object.VAO && candidate.indexCount == object.indexCount &&
+            candidate.indexType == object.indexType && candidate.drawElements == object.drawElements) {
+            group = &candidate;
+            break;
+        }
+    }
+
+    if (group == nullptr) {
+        if (groupCount == groups.size())
+            groups.emplace_back();
+
+        group = &groups[groupCount++];
+        group->VAO = object.VAO;
+        group->indexCount = object.indexCount;
+        group->indexType = object.indexType;
+        group->drawElements = object.drawElements;
+    }
+
+    group->models.push_back(object.GetModelMatrix());
+}
+#pragma endregion
+
+#pragma region PointShadowMap Methods
+namespace {
+    // GL_TEXTURE_CUBE_MAP_POSITIVE_X onward
+    const glm::vec3 cubeFaceDirections[6] = {
+        glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f),
+        glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f)
+    };
+    const glm::vec3 cubeFaceUps[6] = {
+        glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+        glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+        glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f)
+    };
+}
+
+PointShadowMap::PointShadowMap(int resolution_) :
+    enabled(true), resolution(resolution_), nearPlane(0.05f), maxRange(50.0f),
+    FBO(0), cubeTexture(0), casterBuffer(0), streamBuffer(nullptr), allocatedResolution(0), farPlane(0.0f),
+    drawCount(0), renderCount(0), reuseCount(0), groupCount(0),
+    valid(false), renderedPosition(0.0f), renderedFarPlane(0.0f) {}
+
+void PointShadowMap::Init() {
+    depthShader = Shader("assets/shaders/shadow/PointDepth.vert", "assets/shaders/shadow/PointDepth.frag",
+        "assets/shaders/shadow/PointDepth.geom");
+
+    glGenFramebuffers(1, &FBO);
+    glGenTextures(1, &cubeTexture);
+    glGenBuffers(1, &casterBuffer);
+
+    allocate();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void PointShadowMap::Release() {
+    if (FBO == 0)
+        return;
+
+    glDeleteFramebuffers(1, &FBO);
+    glDeleteTextures(1, &cubeTexture);
+    glDeleteBuffers(1, &casterBuffer);
+    glDeleteProgram(depthShader.ID);
+
+    FBO = 0;
+    cubeTexture = 0;
+    casterBuffer = 0;
+    allocatedResolution = 0;
+    valid = false;
+}
+
+void PointShadowMap::SetStreamBuffer(StreamBuffer* streamBuffer_) {
+    streamBuffer = streamBuffer_;
+}
+
+void PointShadowMap::Render(const PointLight& light, const std::vector<Object3D*>& casters_) {
+    drawCount = 0;
+    if (FBO == 0 || !enabled)
+        return;
+
+    resolution = std::max(resolution, 64);
+    farPlane = std::max(std::min(light.GetRadius(), maxRange), 2.0f * nearPlane);
+
+    for (unsigned int i = 0; i < groupCount; i++)
+        groups[i].casters.clear();
+    groupCount = 0;
+    objects.clear();
+
+    for (Object3D* object : casters_) {
+        if (!object->drawn)
+            continue;
+
+        glm::vec4 bounds = object->GetBounds();
+        glm::vec3 offset = glm::vec3(bounds) - light.position;
+        if (glm::length(offset) - bounds.w > farPlane)
+            continue;
+
+        // a face sees the sphere unless it lies past one of the four 45 degree side planes
+        float components[3] = { offset.x, offset.y, offset.z };
+        GLuint faceMask = 0;
+        for (int face = 0; face < 6; face++) {
+            int axis = face / 2;
+            float along = face % 2 == 0 ? components[axis] : -components[axis];
+            if (along + bounds.w < nearPlane)
+                continue;
+
+            bool inside = true;
+            for (int other = 0; other < 3 && inside; other++) {
+                if (other == axis)
+                    continue;
+                inside = (along - components[other]) * 0.70710678f >= -bounds.w &&
+                    (along + components[other]) * 0.70710678f >= -bounds.w;
+            }
+
+            if (inside)
+                faceMask |= 1u << face;
+        }
+
+        if (faceMask == 0)
+            continue;
+
+        objects.push_back(object);
+        addCaster(*object, faceMask);
+    }
+
+    casters.clear();
+    for (unsigned int i = 0; i < groupCount; i++)
+        casters.insert(casters.end(), groups[i].casters.begin(), groups[i].casters.end());
+
+    if (valid && unchanged(light.position)) {
+        reuseCount++;
+        return;
+    }
+
+    int targetFBO;
+    int targetViewport[4];
+    int depthFunc;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &targetFBO);
+    glGetIntegerv(GL_VIEWPORT, targetViewport);
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+
+    if (resolution != allocatedResolution)
+        allocate();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glViewport(0, 0, resolution, resolution);
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LESS);
+    glDepthMask(GL_TRUE);
+    // the attachment is layered, this clears all six faces
+    glClear(GL_DEPTH_BUFFER_BIT);
+
+    if (!casters.empty()) {
+        unsigned int bytes = static_cast<unsigned int>(casters.size() * sizeof(ShadowCaster));
+        GLintptr offset = -1;
+        if (streamBuffer != nullptr)
+            offset = streamBuffer->BindStorage(4, casters.data(), bytes);
+
+        if (offset < 0) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, casterBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, bytes, casters.data(), GL_STREAM_DRAW);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, casterBuffer);
+        }
+
+        depthShader.use();
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+        for (int face = 0; face < 6; face++) {
+            glm::mat4 faceView = glm::lookAt(light.position, light.position + cubeFaceDirections[face], cubeFaceUps[face]);
+            depthShader.setMat4("faceMatrices[" + std::to_string(face) + "]", projection * faceView);
+        }
+        depthShader.setVec3("lightPosition", light.position);
+        depthShader.setFloat("farPlane", farPlane);
+
+        int first = 0;
+        for (unsigned int i = 0; i < groupCount; i++) {
+            CasterGroup& group = groups[i];
+            int count = static_cast<int>(group.casters.size());
+
+            depthShader.setInt("baseCaster", first);
+            glBindVertexArray(group.VAO);
+
+            if (group.drawElements)
+                glDrawElementsInstanced(GL_TRIANGLES, group.indexCount, group.indexType, 0, count);
+            else
+                glDrawArraysInstanced(GL_TRIANGLES, 0, group.indexCount, count);
+
+            first += count;
+            drawCount++;
+        }
+
+        glBindVertexArray(0);
+    }
+
+    glDepthFunc(depthFunc);
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFBO);
+    glViewport(targetViewport[0], targetViewport[1], targetViewport[2], targetViewport[3]);
+
+    valid = true;
+    renderedPosition = light.position;
+    renderedFarPlane = farPlane;
+    renderedObjects = objects;
+    renderedCasters = casters;
+    renderCount++;
+}
+
+void PointShadowMap::Apply(Shader& shader, int unit, int lightIndex) const {
+    shader.setInt("pointShadowLight", enabled && valid ? lightIndex : -1);
+    shader.setInt("pointShadowMap", unit);
+    shader.setFloat("pointShadowFar", renderedFarPlane);
+    shader.setFloat("pointShadowResolution", static_cast<float>(allocatedResolution));
+
+    // bound even when off, a shadow sampler must never see an incomplete texture
+    glActiveTexture(GL_TEXTURE0 + unit);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubeTexture);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+float PointShadowMap::GetFarPlane() const {
+    return renderedFarPlane;
+}
+
+unsigned int PointShadowMap::GetCasterCount() const {
+    return static_cast<unsigned int>(renderedObjects.size());
+}
+
+unsigned int PointShadowMap::GetDrawCount() const {
+    return drawCount;
+}
+
+unsigned int PointShadowMap::GetRenderCount() const {
+    return renderCount;
+}
+
+unsigned int PointShadowMap::GetReuseCount() const {
+    return reuseCount;
+}
+
+void PointShadowMap::allocate() {
+    allocatedResolution = resolution;
+    valid = false;
+
+    // distance to the light over the far plane, written by the fragment shader
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubeTexture);
+    for (int face = 0; face < 6; face++)
+        glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, GL_DEPTH_COMPONENT32F, resolution, resolution, 0,
+            GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, cubeTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::SHADOW::CUBE_FRAMEBUFFER_INCOMPLETE" << std::endl;
+}
+
+void PointShadowMap::addCaster(Object3D& object, GLuint faceMask) {
+    CasterGroup* group = nullptr;
+    for (unsigned int i = 0; i < groupCount; i++) {
+        CasterGroup& candidate = groups[i];
+        if (candidate.VAO == object.VAO && candidate.indexCount == object.indexCount &&
+            candidate.indexType == object.indexType && candidate.drawElements == object.drawElements) {
+            group = &candidate;
+            break;
+        }
+    }
+
+    if (group == nullptr) {
+        if (groupCount == groups.size())
+            groups.emplace_back();
+
+        group = &groups[groupCount++];
+        group->VAO = object.VAO;
+        group->indexCount = object.indexCount;
+        group->indexType = object.indexType;
+        group->drawElements = object.drawElements;
+    }
+
+    group->casters.push_back({ object.GetModelMatrix(), faceMask, { 0, 0, 0 } });
+}
+
+bool PointShadowMap::unchanged(const glm::vec3& position) const {
+    if (position != renderedPosition || farPlane != renderedFarPlane || resolution != allocatedResolution)
+        return false;
+
+    if (objects != renderedObjects || casters.size() != renderedCasters.size())
+        return false;
+
+    // padding is always zeroed, so the bytes compare exactly
+    return casters.empty() || std::memcmp(casters.data(), renderedCasters.data(), casters.size() * sizeof(ShadowCaster)) == 0;
+}
+#pragma endregion
@@ -0,0 +1,101 @@
+#include "skybox.h"
+
+#pragma region Skybox Methods
+Skybox::Skybox() :
+    cubemap(0), emptyVAO(0), queries{ 0, 0 }, currentQuery(0), queryPending{ false, false }, fragmentCount(0),
+    pixelCount(0) {}
+
+void Skybox::Init(unsigned int cubemap_) {
+    shader = Shader("assets/shaders/skybox/VertexShader.vert", "assets/shaders/skybox/FragmentShader.frag");
+    cubemap = cubemap_;
+
+    glGenVertexArrays(1, &emptyVAO);
+    glGenQueries(2, queries);
+    timer.Init();
+}
+
+void Skybox::Release() {
+    if (emptyVAO == 0)
+        return;
+
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteQueries(2, queries);
+    glDeleteProgram(shader.ID);
+    timer.Release();
+
+    emptyVAO = 0;
+    queries[0] = 0;
+    queries[1] = 0;
+    queryPending[0] = false;
+    queryPending[1] = false;
+}
+
+void Skybox::Draw(const glm::mat4& view, const glm::mat4& projection) {
+    if (emptyVAO == 0)
+        return;
+
+    int previous = 1 - currentQuery;
+    if (queryPending[previous]) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(queries[previous], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (available) {
+            GLuint64 samples = 0;
+            glGetQueryObjectui64v(queries[previous], GL_QUERY_RESULT, &samples);
+            fragmentCount = samples;
+            queryPending[previous] = false;
+        }
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    pixelCount = static_cast<unsigned long long>(viewport[2]) * viewport[3];
+
+    GLint depthFunc;
+    glGetIntegerv(GL_DEPTH_FUNC, &depthFunc);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_DEPTH_CLAMP);
+    glDisable(GL_BLEND);
+
+    // the sky doesn't move with the camera, only turns with it
+    shader.use();
+    shader.setInt("skybox", 0);
+    shader.setMat4("inverseViewProjection", glm::inverse(projection * glm::mat4(glm::mat3(view))));
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemap);
+
+    timer.Begin();
+    glBeginQuery(GL_SAMPLES_PASSED, queries[currentQuery]);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glEndQuery(GL_SAMPLES_PASSED);
+    timer.End();
+
+    queryPending[currentQuery] = true;
+    currentQuery = 1 - currentQuery;
+
+    if (blend)
+        glEnable(GL_BLEND);
+    glDisable(GL_DEPTH_CLAMP);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(depthFunc);
+}
+
+unsigned long long Skybox::GetFragmentCount() const {
+    return fragmentCount;
+}
+
+unsigned long long Skybox::GetPixelCount() const {
+    return pixelCount;
+}
+
+float Skybox::GetTime() const {
+    return timer.GetTime();
+}
+#pragma endregion
@@ -0,0 +1,167 @@
+#include "sphericalharmonics.h"
+
+#include <stb_image/stb_image.h>
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+static const int FACE_COUNT = 6;
+static const int ROWS_PER_JOB = 16; // small enough that every thread gets some
+
+struct CubeFace {
+    float* pixels; // rgb
+    int width;
+    int height;
+};
+
+// nine rgb sums, then the summed solid angle
+typedef std::array<double, SphericalHarmonics::COEFFICIENT_COUNT * 3 + 1> ProjectionSums;
+
+// Direction through texel coordinates s, t in [-1, 1] of a face, t growing down the image,
+// laid out like GL samples a cube map. Every one has a squared length of 1 + s^2 + t^2.
+static glm::vec3 faceDirection(int face, float s, float t) {
+    switch (face) {
+    case 0: return glm::vec3(1.0f, -t, -s);
+    case 1: return glm::vec3(-1.0f, -t, s);
+    case 2: return glm::vec3(s, 1.0f, t);
+    case 3: return glm::vec3(s, -1.0f, -t);
+    case 4: return glm::vec3(s, -t, 1.0f);
+    default: return glm::vec3(-s, -t, -1.0f);
+    }
+}
+
+static void projectRows(const CubeFace& face, int faceIndex, int firstRow, int lastRow, ProjectionSums& sums) {
+    __m128 accumulators[SphericalHarmonics::COEFFICIENT_COUNT];
+    for (__m128& accumulator : accumulators)
+        accumulator = _mm_setzero_ps();
+    float solidAngle = 0.0f;
+
+    float texelWidth = 2.0f / face.width;
+    float texelHeight = 2.0f / face.height;
+    for (int y = firstRow; y < lastRow; y++) {
+        float t = (y + 0.5f) * texelHeight - 1.0f;
+        const float* pixel = face.pixels + static_cast<size_t>(y) * face.width * 3;
+
+        for (int x = 0; x < face.width; x++, pixel += 3) {
+            float s = (x + 0.5f) * texelWidth - 1.0f;
+
+            // a texel's solid angle shrinks towards the corners of its face
+            float lengthSquared = 1.0f + s * s + t * t;
+            float inverseLength = 1.0f / std::sqrt(lengthSquared);
+            float weight = inverseLength * inverseLength * inverseLength;
+            glm::vec3 n = faceDirection(faceIndex, s, t) * inverseLength;
+
+            float basis[SphericalHarmonics::COEFFICIENT_COUNT] = {
+                0.282095f,
+                0.488603f * n.y,
+                0.488603f * n.z,
+                0.488603f * n.x,
+                1.092548f * n.x * n.y,
+                1.092548f * n.y * n.z,
+                0.315392f * (3.0f * n.z * n.z - 1.0f),
+                1.092548f * n.x * n.z,
+                0.546274f * (n.x * n.x - n.y * n.y)
+            };
+
+            __m128 color = _mm_mul_ps(_mm_set_ps(0.0f, pixel[2], pixel[1], pixel[0]), _mm_set1_ps(weight));
+            for (int k = 0; k < SphericalHarmonics::COEFFICIENT_COUNT; k++)
+                accumulators[k] = _mm_add_ps(accumulators[k], _mm_mul_ps(color, _mm_set1_ps(basis[k])));
+            solidAngle += weight;
+        }
+    }
+
+    // a band in floats, the whole map in doubles
+    for (int k = 0; k < SphericalHarmonics::COEFFICIENT_COUNT; k++) {
+        alignas(16) float values[4];
+        _mm_store_ps(values, accumulators[k]);
+        sums[k * 3 + 0] += values[0];
+        sums[k * 3 + 1] += values[1];
+        sums[k * 3 + 2] += values[2];
+    }
+    sums.back() += solidAngle;
+}
+
+bool projectCubemap(const std::vector<std::string>& faces, SphericalHarmonics& result) {
+    if (faces.size() != FACE_COUNT) {
+        std::cout << "ERROR::SPHERICAL_HARMONICS::NOT_A_CUBE_MAP" << std::endl;
+        return false;
+    }
+
+    // decoding dominates for small faces, so the faces load in parallel too
+    CubeFace cube[FACE_COUNT];
+    std::vector<std::thread> loaders;
+    for (int i = 0; i < FACE_COUNT; i++) {
+        loaders.emplace_back([&cube, &faces, i]() {
+            int channels;
+            cube[i].pixels = stbi_loadf(faces[i].c_str(), &cube[i].width, &cube[i].height, &channels, 3);
+        });
+    }
+    for (std::thread& loader : loaders)
+        loader.join();
+
+    bool loaded = true;
+    for (int i = 0; i < FACE_COUNT; i++) {
+        if (cube[i].pixels == nullptr) {
+            std::cout << "ERROR::SPHERICAL_HARMONICS::FACE_NOT_LOADED " << faces[i] << std::endl;
+            loaded = false;
+        }
+        else if (cube[i].width != cube[0].width || cube[i].height != cube[0].height) {
+            std::cout << "ERROR::SPHERICAL_HARMONICS::FACE_SIZE_MISMATCH " << faces[i] << std::endl;
+            loaded = false;
+        }
+    }
+
+    if (loaded) {
+        int bandsPerFace = (cube[0].height + ROWS_PER_JOB - 1) / ROWS_PER_JOB;
+        int jobCount = bandsPerFace * FACE_COUNT;
+        int threadCount = std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), jobCount));
+
+        std::vector<ProjectionSums> threadSums(threadCount);
+        std::atomic<int> nextJob(0);
+
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back([&, i]() {
+                threadSums[i].fill(0.0);
+                for (int job = nextJob++; job < jobCount; job = nextJob++) {
+                    int face = job / bandsPerFace;
+                    int firstRow = job % bandsPerFace * ROWS_PER_JOB;
+                    int lastRow = std::min(firstRow + ROWS_PER_JOB, cube[face].height);
+                    projectRows(cube[face], face, firstRow, lastRow, threadSums[i]);
+                }
+            });
+        }
+        for (std::thread& worker : workers)
+            worker.join();
+
+        ProjectionSums sums = {};
+        for (const ProjectionSums& partial : threadSums) {
+            for (size_t j = 0; j < sums.size(); j++)
+                sums[j] += partial[j];
+        }
+
+        // the texel weights only approximate the solid angle, the sphere is 4 pi exactly;
+        // bands are scaled by the cosine lobe's pi, 2 pi / 3 and pi / 4, over pi
+        const float bandScale[SphericalHarmonics::COEFFICIENT_COUNT] = {
+            1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f
+        };
+        double normalization = 4.0 * 3.14159265358979 / sums.back();
+        for (int k = 0; k < SphericalHarmonics::COEFFICIENT_COUNT; k++) {
+            result.coefficients[k] = glm::vec3(
+                static_cast<float>(sums[k * 3 + 0] * normalization),
+                static_cast<float>(sums[k * 3 + 1] * normalization),
+                static_cast<float>(sums[k * 3 + 2] * normalization)) * bandScale[k];
+        }
+    }
+
+    for (CubeFace& face : cube)
+        stbi_image_free(face.pixels);
+
+    return loaded;
+}
@@ -0,0 +1,182 @@
+#include "streambuffer.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#pragma region StreamBuffer Methods
+StreamBuffer::StreamBuffer() :
+    buffer(0), mapped(nullptr), persistent(false), regionSize(0), uniformAlignment(256), storageAlignment(256),
+    fences{}, region(0), head(0), overflowBytes(0), bytesLastFrame(0), bytesRequestedLastFrame(0), waitTime(0.0f),
+    overflowReported(false) {}
+
+void StreamBuffer::Init(unsigned int regionSize_) {
+    regionSize = regionSize_;
+
+    GLint alignment;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    uniformAlignment = static_cast<unsigned int>(alignment);
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    storageAlignment = static_cast<unsigned int>(alignment);
+
+    allocate();
+}
+
+void StreamBuffer::allocate() {
+    // regions start on an alignment every binding accepts
+    regionSize = (regionSize + 255) / 256 * 256;
+    GLsizeiptr size = static_cast<GLsizeiptr>(regionSize) * FRAME_COUNT;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+    // the context asks for 4.3, glBufferStorage is only there when the driver gives more
+    persistent = GLAD_GL_VERSION_4_4 != 0;
+    if (persistent) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+
+        if (mapped == nullptr) {
+            std::cout << "ERROR::STREAM_BUFFER::PERSISTENT_MAP_FAILED" << std::endl;
+            persistent = false;
+
+            // storage is immutable, the fallback needs a buffer of its own
+            glDeleteBuffers(1, &buffer);
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        }
+    }
+
+    if (!persistent)
+        glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+
+    region = 0;
+    head = 0;
+}
+
+void StreamBuffer::Release() {
+    if (buffer == 0)
+        return;
+
+    for (GLsync& fence : fences) {
+        if (fence != nullptr)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (mapped != nullptr) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        mapped = nullptr;
+    }
+
+    glDeleteBuffers(1, &buffer);
+    buffer = 0;
+}
+
+void StreamBuffer::BeginFrame() {
+    // the old buffer is deleted, not written again, so nothing waits on its fences
+    if (buffer != 0 && bytesRequestedLastFrame > regionSize) {
+        unsigned int size = regionSize;
+        while (size < bytesRequestedLastFrame)
+            size *= 2;
+
+        Release();
+        regionSize = size;
+        allocate();
+        bytesRequestedLastFrame = 0;
+    }
+
+    head = 0;
+    overflowBytes = 0;
+    waitTime = 0.0f;
+    overflowReported = false;
+
+    GLsync& fence = fences[region];
+    if (fence == nullptr)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    // flush once so the fence is guaranteed to signal, then keep polling
+    GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+    while (result == GL_TIMEOUT_EXPIRED)
+        result = glClientWaitSync(fence, 0, 1000000); // 1 ms
+
+    if (result == GL_WAIT_FAILED)
+        std::cout << "ERROR::STREAM_BUFFER::FENCE_WAIT_FAILED" << std::endl;
+
+    waitTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+void StreamBuffer::EndFrame() {
+    if (buffer == 0)
+        return;
+
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    bytesLastFrame = head;
+    bytesRequestedLastFrame = head + overflowBytes;
+    region = (region + 1) % FRAME_COUNT;
+}
+
+GLintptr StreamBuffer::Write(const void* data, unsigned int size, unsigned int alignment) {
+    unsigned int offset = (head + alignment - 1) / alignment * alignment;
+    if (buffer == 0 || offset + size > regionSize) {
+        if (!overflowReported)
+            std::cout << "ERROR::STREAM_BUFFER::FRAME_REGION_FULL" << std::endl;
+        overflowReported = true;
+        overflowBytes += size + alignment;
+        return -1;
+    }
+
+    GLintptr bufferOffset = static_cast<GLintptr>(region) * regionSize + offset;
+    if (persistent) {
+        std::memcpy(mapped + bufferOffset, data, size);
+    }
+    else {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, bufferOffset, size, data);
+    }
+
+    head = offset + size;
+    return bufferOffset;
+}
+
+GLintptr StreamBuffer::BindUniform(unsigned int binding, const void* data, unsigned int size) {
+    GLintptr offset = Write(data, size, uniformAlignment);
+    if (offset >= 0)
+        glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size);
+    return offset;
+}
+
+GLintptr StreamBuffer::BindStorage(unsigned int binding, const void* data, unsigned int size) {
+    GLintptr offset = Write(data, size, storageAlignment);
+    if (offset >= 0)
+        glBindBufferRange(GL_SHADER_STORAGE_BUFFER, binding, buffer, offset, size);
+    return offset;
+}
+
+unsigned int StreamBuffer::GetBuffer() const {
+    return buffer;
+}
+
+bool StreamBuffer::IsPersistent() const {
+    return persistent;
+}
+
+unsigned int StreamBuffer::GetRegionSize() const {
+    return regionSize;
+}
+
+unsigned int StreamBuffer::GetBytesLastFrame() const {
+    return bytesLastFrame;
+}
+
+float StreamBuffer::GetWaitTime() const {
+    return waitTime;
+}
+#pragma endregion
@@ -0,0 +1,115 @@
+#include "tiledlights.h"
+
+// std430 size of a LightTile in the shaders: point count, spot mask, then the indices
+const GLsizeiptr TILE_BYTES = (2 + TiledLightCuller::MAX_TILE_LIGHTS) * sizeof(GLuint);
+
+// the pre-pass depth, units 0 to 4 are the material maps and the shadow maps
+const int DEPTH_UNIT = 5;
+
+#pragma region TiledLightCuller Methods
+TiledLightCuller::TiledLightCuller(float maxCount_) :
+    maxCount(maxCount_), tileBuffer(0), emptyVAO(0), width(0), height(0),
+    tileCountX(0), tileCountY(0) {}
+
+void TiledLightCuller::Init(int screenWidth, int screenHeight) {
+    cullShader = Shader("assets/shaders/tiled/LightCull.comp");
+    heatmapShader = Shader("assets/shaders/outline/Fullscreen.vert", "assets/shaders/tiled/Heatmap.frag");
+
+    glGenBuffers(1, &tileBuffer);
+    glGenVertexArrays(1, &emptyVAO);
+
+    Resize(screenWidth, screenHeight);
+}
+
+void TiledLightCuller::Release() {
+    if (tileBuffer == 0)
+        return;
+
+    glDeleteBuffers(1, &tileBuffer);
+    glDeleteVertexArrays(1, &emptyVAO);
+    glDeleteProgram(cullShader.ID);
+    glDeleteProgram(heatmapShader.ID);
+
+    tileBuffer = 0;
+    emptyVAO = 0;
+    width = 0;
+    height = 0;
+    tileCountX = 0;
+    tileCountY = 0;
+}
+
+void TiledLightCuller::Resize(int screenWidth, int screenHeight) {
+    if (screenWidth == width && screenHeight == height)
+        return;
+
+    // minimized windows report a zero-sized framebuffer
+    if (screenWidth <= 0 || screenHeight <= 0)
+        return;
+
+    width = screenWidth;
+    height = screenHeight;
+    tileCountX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    tileCountY = (height + TILE_SIZE - 1) / TILE_SIZE;
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, tileBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, TILE_BYTES * tileCountX * tileCountY, NULL, GL_DYNAMIC_COPY);
+}
+
+void TiledLightCuller::Cull(const RenderTarget& scene, const glm::mat4& view, const glm::mat4& projection,
+    unsigned int pointLightCount) {
+    if (tileBuffer == 0)
+        return;
+
+    cullShader.use();
+    cullShader.setInt("depth", DEPTH_UNIT);
+    cullShader.setMat4("view", view);
+    cullShader.setMat4("inverseProjection", glm::inverse(projection));
+    cullShader.setInt("pointLightCount", static_cast<int>(pointLightCount));
+
+    glActiveTexture(GL_TEXTURE0 + DEPTH_UNIT);
+    glBindTexture(GL_TEXTURE_2D, scene.depthTexture);
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TILE_BINDING, tileBuffer);
+    glDispatchCompute(tileCountX, tileCountY, 1);
+
+    // still attached to the scene, the shading pass must not find it bound for sampling
+    glActiveTexture(GL_TEXTURE0 + DEPTH_UNIT);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void TiledLightCuller::Apply(Shader& shader) const {
+    shader.setInt("tileCountX", tileCountX);
+}
+
+void TiledLightCuller::DrawHeatmap() {
+    if (tileBuffer == 0)
+        return;
+
+    glDisable(GL_DEPTH_TEST);
+
+    heatmapShader.use();
+    heatmapShader.setInt("tileCountX", tileCountX);
+    heatmapShader.setFloat("maxCount", maxCount);
+
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TILE_BINDING, tileBuffer);
+    glBindVertexArray(emptyVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+
+    glEnable(GL_DEPTH_TEST);
+}
+
+Shader& TiledLightCuller::GetCullShader() {
+    return cullShader;
+}
+
+int TiledLightCuller::GetTileCountX() const {
+    return tileCountX;
+}
+
+int TiledLightCuller::GetTileCountY() const {
+    return tileCountY;
+}
+#pragma endregion